@@ -0,0 +1,130 @@
+/*
+ * cartesian_density.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Wall time of the CARTESIAN DISK density (llDensity), whose pixels only test the points bucketed near them,
+ * on a uniform point cloud. The counts are first checked against the brute-force loop over all points on a
+ * small case.
+ *
+ * usage: cartesian_density [points width height bandwidth threads]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "alg/density.hpp"
+#include "glm/gtx/norm.hpp"
+#include "templates/tensor.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/parameters.hpp"
+
+namespace
+{
+
+const int ORIGINAL_SIZE = 1024;
+
+std::unique_ptr<elib::Tensor<double>> cartesianDensity(elib::Tensor<double> &points, int width, int height,
+		double band_width, int num_threads)
+{
+	elib::Tensor<int> dimensions(1, std::vector<int>{2}), original_dimensions(1, std::vector<int>{2});
+	dimensions.getData()[0] = width;
+	dimensions.getData()[1] = height;
+	original_dimensions.getData()[0] = ORIGINAL_SIZE;
+	original_dimensions.getData()[1] = ORIGINAL_SIZE;
+	elib::Parameters parameters;
+	parameters.addParameter("Dimensions", dimensions);
+	parameters.addParameter("OriginalDimensions", original_dimensions);
+	parameters.addParameter("Rank", 2);
+	parameters.addParameter("Radius", 1.);
+	parameters.addParameter("LateralProjectionRange", 1.);
+	parameters.addParameter("BandWidth", band_width);
+	parameters.addParameter("Type", static_cast<int>(elib::Density::density_type::CARTESIAN));
+	parameters.addParameter("CentralMeridian", 0.);
+	parameters.addParameter("StandardParallel", 1.);
+	parameters.addParameter("Threads", num_threads);
+	return std::unique_ptr<elib::Tensor<double>>(elib::Density::calculateDensity(points, parameters));
+}
+
+elib::Tensor<double> randomPoints(int num_points, std::mt19937 &generator)
+{
+	// a margin around the image, points outside count towards the pixels at the border
+	std::uniform_real_distribution<double> coordinate(-20, ORIGINAL_SIZE+20);
+	elib::Tensor<double> points(1, std::vector<int>{2*num_points});
+	for(int i=0; i<2*num_points; ++i)
+	{
+		points.getData()[i] = coordinate(generator);
+	}
+	return points;
+}
+
+/* number of pixels whose count differs from testing every point with the criterion of calculateDensity */
+long long bruteForceDifferences(const elib::Tensor<double> &points, const elib::Tensor<double> &density, int width, int height,
+		double band_width)
+{
+	std::vector<glm::vec3> scaled;
+	for(int k=0; k<points.getFlattenedLength(); k+=2)
+	{
+		scaled.push_back(glm::vec3(points.get(k)/ORIGINAL_SIZE, points.get(k+1)/ORIGINAL_SIZE, 0));
+	}
+	long long differences = 0;
+	for(int j=0; j<height; ++j)
+	{
+		for(int i=0; i<width; ++i)
+		{
+			glm::vec3 q(double(i)/width, double(j)/height, 0);
+			int count = 0;
+			for(const glm::vec3 &p : scaled)
+			{
+				count += std::sqrt(glm::l2Norm(q-p)) <= band_width;
+			}
+			differences += count != density.get(i + j*width);
+		}
+	}
+	return differences;
+}
+
+} /* end anonymous namespace */
+
+int main(int argc, char **argv)
+{
+	int num_points = argc > 1 ? std::atoi(argv[1]) : 1000000,
+		width = argc > 2 ? std::atoi(argv[2]) : 1024,
+		height = argc > 3 ? std::atoi(argv[3]) : 1024,
+		num_threads = argc > 5 ? std::atoi(argv[5]) : 0;
+	double band_width = argc > 4 ? std::atof(argv[4]) : 0.1;
+	std::mt19937 generator(1);
+
+	long long differences = 0;
+	for(double small_band_width : {0.05, 0.2, 0.5})
+	{
+		elib::Tensor<double> points = randomPoints(5000, generator);
+		std::unique_ptr<elib::Tensor<double>> density = cartesianDensity(points, 96, 80, small_band_width, num_threads);
+		differences += density == nullptr ? 1 : bruteForceDifferences(points, *density, 96, 80, small_band_width);
+	}
+	std::printf("5000 points on 96x80 against brute force: %lld differing pixels\n", differences);
+
+	elib::Tensor<double> points = randomPoints(num_points, generator);
+	auto start = std::chrono::steady_clock::now();
+	std::unique_ptr<elib::Tensor<double>> density = cartesianDensity(points, width, height, band_width, num_threads);
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+	if(density == nullptr)
+		return 1;
+	double total = 0;
+	for(int i=0; i<density->getFlattenedLength(); ++i)
+	{
+		total += density->get(i);
+	}
+	std::printf("%d points on %dx%d, band width %g, %d threads: %.1f ms, %.3g counts, brute force would test %.3g pairs\n",
+			num_points, width, height, band_width, num_threads > 0 ? num_threads : elib::defaultNumberOfThreads(),
+			milliseconds, total, double(num_points)*width*height);
+	return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+/*
+ * connected_components.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Wall time of the union-find ConnectedComponents::getComponents against a breadth-first search labeling
+ * on random binary images, for 2D and 3D and every connectivity, with 1, 3 and the given number of threads.
+ * Both number components in scan order of their first pixel, so the labels have to be identical.
+ *
+ * usage: connected_components [width height depth density threads]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "alg/connected_components.hpp"
+#include "glm/glm.hpp"
+#include "templates/image.hpp"
+#include "utilities/parallel.hpp"
+
+namespace
+{
+
+const int LABEL_OFFSET = 5;
+
+const std::vector<glm::ivec3>& neighbours(int rank, short connectivity)
+{
+	typedef elib::ConnectedComponents CC;
+	if(rank == 2)
+		return connectivity == CC::SMALL_CONNECTIVITY ? CC::SMALL_2D : CC::LARGE_2D;
+	switch(connectivity)
+	{
+		case CC::SMALL_CONNECTIVITY:
+			return CC::SMALL_3D;
+		case CC::LARGE_CONNECTIVITY:
+			return CC::LARGE_3D;
+		case CC::EDGE_CONNECTIVITY:
+			return CC::EDGE_3D;
+		default:
+			return CC::FULL_3D;
+	}
+}
+
+/* reference labeling, one breadth-first search per component started at its first pixel in scan order */
+std::vector<int> breadthFirstComponents(const elib::Image<int> &image, const std::vector<glm::ivec3> &offsets)
+{
+	int width = image.getWidth(), height = image.getHeight(), depth = image.getRank() == 3 ? image.getDepth() : 1;
+	const int *data = image.getData();
+	std::size_t length = std::size_t(width)*height*depth;
+	std::vector<int> labels(length, 0);
+	std::queue<std::size_t> pixels;
+	int label = LABEL_OFFSET;
+	for(std::size_t start=0; start<length; ++start)
+	{
+		if(data[start] <= 0 || labels[start] != 0)
+			continue;
+		labels[start] = label;
+		pixels.push(start);
+		while(!pixels.empty())
+		{
+			std::size_t pixel = pixels.front();
+			pixels.pop();
+			int x = int(pixel%width), y = int((pixel/width)%height), z = int(pixel/(std::size_t(width)*height));
+			for(const glm::ivec3 &o : offsets)
+			{
+				int nx = x+o.x, ny = y+o.y, nz = z+o.z;
+				if(nx < 0 || ny < 0 || nz < 0 || nx >= width || ny >= height || nz >= depth)
+					continue;
+				std::size_t neighbour = nx + (ny + std::size_t(nz)*height)*width;
+				if(data[neighbour] > 0 && labels[neighbour] == 0)
+				{
+					labels[neighbour] = label;
+					pixels.push(neighbour);
+				}
+			}
+		}
+		++label;
+	}
+	return labels;
+}
+
+} /* end anonymous namespace */
+
+int main(int argc, char **argv)
+{
+	int width = argc > 1 ? std::atoi(argv[1]) : 512,
+		height = argc > 2 ? std::atoi(argv[2]) : 512,
+		depth = argc > 3 ? std::atoi(argv[3]) : 64,
+		num_threads = argc > 5 ? std::atoi(argv[5]) : elib::defaultNumberOfThreads();
+	double density = argc > 4 ? std::atof(argv[4]) : 0.45;
+	std::mt19937 generator(1);
+	std::bernoulli_distribution foreground(density);
+
+	auto milliseconds = [](std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+	};
+
+	long long differences = 0;
+	for(int rank=2; rank<=3; ++rank)
+	{
+		std::vector<int> dimensions = {width, height};
+		if(rank == 3)
+			dimensions.push_back(depth);
+		elib::Image<int> image(rank, dimensions, 16, 1);
+		for(int i=0; i<image.getFlattenedLength(); ++i)
+		{
+			image.getData()[i] = foreground(generator);
+		}
+		std::printf("%dD %dx%dx%d, foreground %.2f\n", rank, width, height, rank == 3 ? depth : 1, density);
+
+		for(short connectivity=elib::ConnectedComponents::SMALL_CONNECTIVITY;
+				connectivity<=(rank == 2 ? elib::ConnectedComponents::LARGE_CONNECTIVITY : elib::ConnectedComponents::FULL_CONNECTIVITY);
+				++connectivity)
+		{
+			const std::vector<glm::ivec3> &offsets = neighbours(rank, connectivity);
+			auto start = std::chrono::steady_clock::now();
+			std::vector<int> reference = breadthFirstComponents(image, offsets);
+			double reference_ms = milliseconds(start);
+			std::printf("  %2d neighbours: BFS %9.1f ms", int(offsets.size()), reference_ms);
+
+			for(int threads : {1, 3, num_threads})
+			{
+				elib::ConnectedComponents components;
+				components.setConnectivity(connectivity);
+				components.setLabelOffset(LABEL_OFFSET);
+				components.setNumberOfThreads(threads);
+				start = std::chrono::steady_clock::now();
+				elib::Image<int> labels = components.getComponents(image);
+				double union_find_ms = milliseconds(start);
+				for(std::size_t i=0; i<reference.size(); ++i)
+				{
+					differences += labels.getData()[i] != reference[i];
+				}
+				std::printf(", union-find %d threads %8.1f ms", threads, union_find_ms);
+			}
+			std::printf("\n");
+		}
+	}
+	std::printf("differing labels against BFS: %lld\n", differences);
+	return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * data_costs.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Setup time and memory of the multi label graph cut, whose data costs GCO evaluates through a functor on
+ * the intensity and the previous label of a pixel, against the pixels x labels table setDataCost needs. The
+ * setup keeps the grid graph of GCO and a label index per pixel. The cut then runs one localized expansion
+ * cycle, whose peak heap is the max-flow graph of the expansions of the background and appearing objects on
+ * the whole image. Without arguments 1024^2 x 200 and 2048^2 x 500 labels are measured.
+ *
+ * usage: data_costs [width labels threads]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "alg/multi_label_graphcut.hpp"
+#include "gco/GCoptimization.h"
+#include "heap_counter.hpp"
+#include "templates/image.hpp"
+#include "utilities/parameters.hpp"
+#include "utilities/profile.hpp"
+
+namespace
+{
+
+/* the labels 2.. on disks in a grid of square cells, the intensities show the disks slightly moved */
+void disks(elib::Image<int> &labels, elib::Image<int> &input, int num_labels)
+{
+	int width = labels.getWidth(), side = 1;
+	while(side*side < num_labels-2)
+		++side;
+	int cell = width/side;
+	std::mt19937 generator(1);
+	std::normal_distribution<double> noise(0, 20);
+	for(int y=0; y<width; ++y)
+	{
+		for(int x=0; x<width; ++x)
+		{
+			int id = (y/cell)*side + x/cell;
+			double dx = x%cell - cell/2., dy = y%cell - cell/2.;
+			bool previous = id < num_labels-2 && dx*dx + dy*dy < cell*cell/9.,
+				moved = id < num_labels-2 && (dx-2)*(dx-2) + (dy+1)*(dy+1) < cell*cell/9.;
+			labels.getData()[x + std::size_t(y)*width] = previous ? id+2 : 0;
+			input.getData()[x + std::size_t(y)*width] = std::max(0, std::min(255, int((moved ? 180 : 40) + noise(generator))));
+		}
+	}
+}
+
+bool measure(int width, int num_labels, int num_threads)
+{
+	std::vector<int> dimensions = {width, width};
+	elib::Image<int> labels(2, dimensions, 16, 1), input(2, dimensions, 8, 1);
+	disks(labels, input, num_labels);
+	long long length = labels.getFlattenedLength();
+
+	elib::Parameters parameters;
+	parameters.addParameter("NumberLabels", num_labels);
+	parameters.addParameter("C0", 0.15);
+	parameters.addParameter("C1", 0.7);
+	parameters.addParameter("Lambda", 0.3);
+	parameters.addParameter("Sigma", 0.5);
+	parameters.addParameter("Mu", 0.4);
+	parameters.addParameter("Optimizer", static_cast<int>(elib::MultiLabelGraphcut::optimizer_type::EXPANSION));
+	parameters.addParameter("LabelRadius", 2);
+	parameters.addParameter("MaxCycles", 1);
+	parameters.addParameter("Threads", num_threads);
+
+	elib::Profile &profile = elib::Profile::getInstance();
+	profile.reset();
+	elib::MultiLabelGraphcut mlgc;
+	long long base = resetHeapPeak();
+	std::shared_ptr<elib::Image<int>> result = mlgc.multilabel_graphcut(labels, input, parameters);
+	if(result == nullptr)
+		return false;
+	auto phases = profile.getPhases();
+	double peak_bytes = double(heap_peak-base);
+
+	// what the setup keeps: the grid graph of GCO and the index of the previous label of every pixel
+	base = heap_bytes;
+	std::unique_ptr<GCoptimizationGridGraph> graph(new GCoptimizationGridGraph(width, width, num_labels));
+	double setup_bytes = double(heap_bytes-base) + double(length)*sizeof(int),
+		table_bytes = double(length)*num_labels*sizeof(GCoptimization::EnergyTermType);
+	std::printf("%dx%d, %d labels\n", width, width, num_labels);
+	std::printf("  setup %10.1f ms %10.1f MB %8.1f B/pixel\n", phases["multilabel setup"].milliseconds, setup_bytes/1e6,
+			setup_bytes/length);
+	std::printf("  cycle %10.1f ms %10.1f MB %8.1f B/pixel peak heap\n", phases["multilabel optimization"].milliseconds,
+			peak_bytes/1e6, peak_bytes/length);
+	std::printf("  a setDataCost table needs %.1f MB, %.0f B/pixel\n", table_bytes/1e6, table_bytes/length);
+	return true;
+}
+
+} /* end anonymous namespace */
+
+int main(int argc, char **argv)
+{
+	int num_threads = argc > 3 ? std::atoi(argv[3]) : 0;
+	elib::Profile::getInstance().setEnabled(true);
+	bool valid = true;
+	if(argc > 2)
+	{
+		valid = measure(std::atoi(argv[1]), std::atoi(argv[2]), num_threads);
+	}
+	else
+	{
+		valid &= measure(1024, 200, num_threads);
+		valid &= measure(2048, 500, num_threads);
+	}
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/*
+ * graphcut_batch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Per frame throughput of graphcutBatch (llGraphCutBatch) against one graphcut call per frame (llGraphCut) on
+ * synthetic noisy disks, checking that both give the same labels.
+ *
+ * usage: graphcut_batch [width height frames threads solver]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "alg/graphcut.hpp"
+#include "templates/image_view.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/parameters.hpp"
+
+int main(int argc, char **argv)
+{
+	int width = argc > 1 ? std::atoi(argv[1]) : 256,
+		height = argc > 2 ? std::atoi(argv[2]) : 256,
+		num_frames = argc > 3 ? std::atoi(argv[3]) : 64,
+		num_threads = argc > 4 ? std::atoi(argv[4]) : 0,
+		solver = argc > 5 ? std::atoi(argv[5]) : static_cast<int>(elib::graphcut_solver::GRID),
+		bit_depth = 8;
+	std::vector<int> dimensions = {width, height};
+	std::size_t frame_length = std::size_t(width)*height;
+
+	std::vector<long long> frames(frame_length*num_frames), single(frames.size()), batch(frames.size());
+	std::mt19937 generator(1);
+	std::normal_distribution<double> noise(0, 30);
+	for(int f=0; f<num_frames; ++f)
+	{
+		double cx = width*(0.3+0.4*f/std::max(1, num_frames-1)), cy = height/2., r = std::min(width, height)/4.;
+		for(int y=0; y<height; ++y)
+		{
+			for(int x=0; x<width; ++x)
+			{
+				bool inside = (x-cx)*(x-cx) + (y-cy)*(y-cy) < r*r;
+				frames[f*frame_length + x + y*width] = std::max(0, std::min(255, int((inside ? 180 : 60) + noise(generator))));
+			}
+		}
+	}
+
+	elib::Parameters parameters;
+	parameters.addParameter("C0", 60./255);
+	parameters.addParameter("C1", 180./255);
+	parameters.addParameter("Lambda", 0.3);
+	parameters.addParameter("Sigma", 0.5);
+	parameters.addParameter("Solver", solver);
+	parameters.addParameter("Threads", num_threads);
+
+	auto now = []()
+	{
+		return std::chrono::steady_clock::now();
+	};
+	auto start = now();
+	for(int f=0; f<num_frames; ++f)
+	{
+		elib::ImageView<int, long long> input_image(&frames[f*frame_length], dimensions, bit_depth, 1);
+		elib::ImageView<short, long long> binary_image(&single[f*frame_length], dimensions, bit_depth, 1);
+		if(!elib::graphcut(input_image, binary_image, parameters))
+			return 1;
+	}
+	double single_ms = std::chrono::duration<double, std::milli>(now()-start).count();
+
+	start = now();
+	if(!elib::graphcutBatch(frames.data(), batch.data(), num_frames, dimensions, bit_depth, parameters, num_threads))
+		return 1;
+	double batch_ms = std::chrono::duration<double, std::milli>(now()-start).count();
+
+	std::size_t differences = 0;
+	for(std::size_t i=0; i<frames.size(); ++i)
+	{
+		differences += single[i] != batch[i];
+	}
+	std::printf("%d frames of %dx%d, %d threads, solver %d\n", num_frames, width, height,
+			num_threads > 0 ? num_threads : elib::defaultNumberOfThreads(), solver);
+	std::printf("single: %8.2f ms/frame %8.1f frames/s\n", single_ms/num_frames, 1000.*num_frames/single_ms);
+	std::printf("batch:  %8.2f ms/frame %8.1f frames/s\n", batch_ms/num_frames, 1000.*num_frames/batch_ms);
+	std::printf("differing labels: %zu\n", differences);
+	return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ * grid_graph_3d.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Bytes per voxel of the multi label graph cut of a volume of noisy, slightly moved spheres on the 3D grid
+ * graph of GCO with the 6, 18 and 26 neighbourhoods, against cutting it slice by slice on the 2D grid graph.
+ * Reports the graph alone, before any move, and the peak heap and wall time of two swap cycles.
+ *
+ * usage: grid_graph_3d [width height depth objects threads]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "alg/multi_label_graphcut.hpp"
+#include "gco/GCoptimization.h"
+#include "heap_counter.hpp"
+#include "templates/image.hpp"
+#include "utilities/parameters.hpp"
+
+namespace
+{
+
+const int CYCLES = 2;
+
+struct Cut
+{
+	double milliseconds = 0;
+	double peak_bytes = 0;	/* per voxel of the image cut */
+	double energy = 0;
+	bool valid = true;
+};
+
+Cut multiLabelCut(elib::Image<int> &labels, elib::Image<int> &input, int num_labels, int neighborhood, int num_threads)
+{
+	elib::Parameters parameters;
+	parameters.addParameter("NumberLabels", num_labels);
+	parameters.addParameter("C0", 0.15);
+	parameters.addParameter("C1", 0.7);
+	parameters.addParameter("Lambda", 0.3);
+	parameters.addParameter("Sigma", 0.5);
+	parameters.addParameter("Mu", 0.4);
+	parameters.addParameter("MaxCycles", CYCLES);
+	parameters.addParameter("Neighborhood", neighborhood);
+	parameters.addParameter("Threads", num_threads);
+	elib::MultiLabelGraphcut mlgc;
+	Cut cut;
+	long long base = resetHeapPeak();
+	auto start = std::chrono::steady_clock::now();
+	std::shared_ptr<elib::Image<int>> result = mlgc.multilabel_graphcut(labels, input, parameters);
+	cut.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+	cut.peak_bytes = double(heap_peak-base)/labels.getFlattenedLength();
+	cut.valid = result != nullptr;
+	if(cut.valid)
+		cut.energy = mlgc.getTrace().back().energy;
+	return cut;
+}
+
+/* heap taken by the graph right after its construction, per site */
+template<typename Graph, typename... Arguments>
+double graphBytes(long long num_sites, Arguments... arguments)
+{
+	long long base = heap_bytes;
+	std::unique_ptr<Graph> graph(new Graph(arguments...));
+	return double(heap_bytes-base)/num_sites;
+}
+
+} /* end anonymous namespace */
+
+int main(int argc, char **argv)
+{
+	int width = argc > 1 ? std::atoi(argv[1]) : 128,
+		height = argc > 2 ? std::atoi(argv[2]) : 128,
+		depth = argc > 3 ? std::atoi(argv[3]) : 32,
+		num_objects = argc > 4 ? std::atoi(argv[4]) : 12,
+		num_threads = argc > 5 ? std::atoi(argv[5]) : 0,
+		num_labels = num_objects+2,
+		radius = std::max(2, std::min(width, std::min(height, depth))/6);
+	std::vector<int> dimensions = {width, height, depth}, slice_dimensions = {width, height};
+	long long slice_length = (long long)width*height;
+
+	// previous labels 2.. on spheres, the intensities show the spheres moved by up to a quarter radius
+	elib::Image<int> labels(3, dimensions, 16, 1), input(3, dimensions, 8, 1);
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> x(0, width-1), y(0, height-1), z(0, depth-1), step(-radius/4, radius/4);
+	std::normal_distribution<double> noise(0, 25);
+	std::fill(input.getData(), input.getData()+input.getFlattenedLength(), 40);
+	for(int l=2; l<num_labels; ++l)
+	{
+		int cx = x(generator), cy = y(generator), cz = z(generator),
+			mx = cx+step(generator), my = cy+step(generator), mz = cz+step(generator);
+		for(long long i=0; i<labels.getFlattenedLength(); ++i)
+		{
+			int px = int(i%width), py = int((i/width)%height), pz = int(i/slice_length);
+			if((px-cx)*(px-cx) + (py-cy)*(py-cy) + (pz-cz)*(pz-cz) <= radius*radius)
+				labels.getData()[i] = l;
+			if((px-mx)*(px-mx) + (py-my)*(py-my) + (pz-mz)*(pz-mz) <= radius*radius)
+				input.getData()[i] = 180;
+		}
+	}
+	for(long long i=0; i<input.getFlattenedLength(); ++i)
+	{
+		input.getData()[i] = std::max(0, std::min(255, int(input.getData()[i] + noise(generator))));
+	}
+	std::vector<elib::Image<int>> label_slices, input_slices;
+	for(int k=0; k<depth; ++k)
+	{
+		label_slices.emplace_back(2, slice_dimensions, 16, 1);
+		input_slices.emplace_back(2, slice_dimensions, 8, 1);
+		std::copy(labels.getData()+k*slice_length, labels.getData()+(k+1)*slice_length, label_slices.back().getData());
+		std::copy(input.getData()+k*slice_length, input.getData()+(k+1)*slice_length, input_slices.back().getData());
+	}
+
+	std::printf("%dx%dx%d, %d labels, %d swap cycles\n", width, height, depth, num_labels, CYCLES);
+	std::printf("%-14s %12s %16s %12s %14s\n", "graph", "B/voxel", "peak B/voxel", "ms", "energy");
+	bool valid = true;
+	for(int neighborhood : {6, 18, 26})
+	{
+		double bytes = graphBytes<GCoptimizationGridGraph3D>(labels.getFlattenedLength(), width, height, depth, num_labels, neighborhood);
+		Cut cut = multiLabelCut(labels, input, num_labels, neighborhood, num_threads);
+		valid &= cut.valid;
+		std::printf("3D %-11d %12.1f %16.1f %12.1f %14.0f\n", neighborhood, bytes, cut.peak_bytes, cut.milliseconds, cut.energy);
+	}
+
+	// per slice: the peak of the largest slice, the time and energy of all slices
+	double bytes = graphBytes<GCoptimizationGridGraph>(slice_length, width, height, num_labels);
+	Cut slices;
+	for(int k=0; k<depth; ++k)
+	{
+		Cut cut = multiLabelCut(label_slices[k], input_slices[k], num_labels, 6, num_threads);
+		slices.milliseconds += cut.milliseconds;
+		slices.peak_bytes = std::max(slices.peak_bytes, cut.peak_bytes);
+		slices.energy += cut.energy;
+		valid &= cut.valid;
+	}
+	std::printf("%-14s %12.1f %16.1f %12.1f %14.0f\n", "per slice 4", bytes, slices.peak_bytes, slices.milliseconds, slices.energy);
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/*
+ * heap_counter.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef HEAP_COUNTER_HPP_
+#define HEAP_COUNTER_HPP_
+
+/*
+ * Heap in use and its peak for the benchmark programs, include in exactly one translation unit. With glibc
+ * malloc, calloc, realloc and free are replaced, which also counts operator new and the malloc based graphs
+ * of GCO, otherwise only operator new and delete are.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace
+{
+
+std::atomic<long long> heap_bytes(0), heap_peak(0);
+
+void heapAllocated(long long size)
+{
+	long long current = heap_bytes += size,
+		previous = heap_peak;
+	while(current > previous && !heap_peak.compare_exchange_weak(previous, current));
+}
+
+/* starts the peak at the heap currently in use, which is returned */
+long long resetHeapPeak()
+{
+	long long base = heap_bytes;
+	heap_peak = base;
+	return base;
+}
+
+} /* end anonymous namespace */
+
+#if defined(__GLIBC__)
+
+extern "C"
+{
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void *pointer, std::size_t size);
+void __libc_free(void *pointer);
+
+void* malloc(std::size_t size) noexcept
+{
+	void *pointer = __libc_malloc(size);
+	if(pointer != nullptr)
+		heapAllocated(malloc_usable_size(pointer));
+	return pointer;
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+	void *pointer = __libc_calloc(count, size);
+	if(pointer != nullptr)
+		heapAllocated(malloc_usable_size(pointer));
+	return pointer;
+}
+
+void* realloc(void *pointer, std::size_t size) noexcept
+{
+	long long old_size = pointer != nullptr ? malloc_usable_size(pointer) : 0;
+	void *new_pointer = __libc_realloc(pointer, size);
+	if(new_pointer != nullptr)
+	{
+		heap_bytes -= old_size;
+		heapAllocated(malloc_usable_size(new_pointer));
+	}
+	else if(size == 0)
+	{
+		heap_bytes -= old_size;
+	}
+	return new_pointer;
+}
+
+void free(void *pointer) noexcept
+{
+	if(pointer == nullptr)
+		return;
+	heap_bytes -= malloc_usable_size(pointer);
+	__libc_free(pointer);
+}
+
+} /* extern "C" */
+
+#else
+
+void* operator new(std::size_t size)
+{
+	// the size is kept in front of the block for operator delete
+	std::size_t *block = static_cast<std::size_t*>(std::malloc(size + sizeof(std::max_align_t)));
+	if(block == nullptr)
+		throw std::bad_alloc();
+	*block = size;
+	heapAllocated(size);
+	return reinterpret_cast<char*>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void *pointer) noexcept
+{
+	if(pointer == nullptr)
+		return;
+	std::size_t *block = reinterpret_cast<std::size_t*>(static_cast<char*>(pointer) - sizeof(std::max_align_t));
+	heap_bytes -= *block;
+	std::free(block);
+}
+
+#endif
+
+#endif /* HEAP_COUNTER_HPP_ */
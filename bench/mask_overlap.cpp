@@ -0,0 +1,187 @@
+/*
+ * mask_overlap.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Memory and overlap cost of the point list of Mask against its run-length representation RunLengthMask on
+ * two frames of a volume of moving spheres, as when matching the objects of consecutive frames. Checks the
+ * overlapping pairs and the negation against a pixel scan of the label images.
+ *
+ * usage: mask_overlap [width height depth objects radius]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "templates/image.hpp"
+#include "templates/mask.hpp"
+#include "templates/run_length_mask.hpp"
+
+namespace
+{
+
+/* spheres at the given centres, later spheres overwrite earlier ones */
+elib::Image<int> spheres(const std::vector<int> &dimensions, const std::vector<glm::ivec3> &centres, int radius)
+{
+	elib::Image<int> image(3, dimensions, 16, 1);
+	int *data = image.getData();
+	for(std::size_t l=0; l<centres.size(); ++l)
+	{
+		const glm::ivec3 &c = centres[l];
+		for(int z=std::max(0, c.z-radius); z<=std::min(dimensions[2]-1, c.z+radius); ++z)
+		{
+			for(int y=std::max(0, c.y-radius); y<=std::min(dimensions[1]-1, c.y+radius); ++y)
+			{
+				for(int x=std::max(0, c.x-radius); x<=std::min(dimensions[0]-1, c.x+radius); ++x)
+				{
+					if((x-c.x)*(x-c.x) + (y-c.y)*(y-c.y) + (z-c.z)*(z-c.z) <= radius*radius)
+						data[x + (y + std::size_t(z)*dimensions[1])*dimensions[0]] = int(l)+1;
+				}
+			}
+		}
+	}
+	return image;
+}
+
+/* point list masks as ComponentsMeasurements builds them */
+std::map<int, elib::Mask<glm::ivec3>> pointMasks(const elib::Image<int> &image)
+{
+	std::map<int, elib::Mask<glm::ivec3>> masks;
+	const int *data = image.getData();
+	for(int z=0; z<image.getDepth(); ++z)
+	{
+		for(int y=0; y<image.getHeight(); ++y)
+		{
+			for(int x=0; x<image.getWidth(); ++x)
+			{
+				int label = data[x + (y + std::size_t(z)*image.getHeight())*image.getWidth()];
+				if(label > 0)
+				{
+					auto mask = masks.find(label);
+					if(mask == masks.end())
+						mask = masks.insert(std::make_pair(label, elib::Mask<glm::ivec3>(3, *image.getDimensions()))).first;
+					mask->second.addPoint(glm::ivec3(x, y, z));
+				}
+			}
+		}
+	}
+	return masks;
+}
+
+} /* end anonymous namespace */
+
+int main(int argc, char **argv)
+{
+	typedef elib::RunLengthMask<glm::ivec3> RunLengthMask;
+	int width = argc > 1 ? std::atoi(argv[1]) : 256,
+		height = argc > 2 ? std::atoi(argv[2]) : 256,
+		depth = argc > 3 ? std::atoi(argv[3]) : 64,
+		num_objects = argc > 4 ? std::atoi(argv[4]) : 40,
+		radius = argc > 5 ? std::atoi(argv[5]) : 20;
+	std::vector<int> dimensions = {width, height, depth};
+
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<int> x(0, width-1), y(0, height-1), z(0, depth-1), step(-radius/2, radius/2);
+	std::vector<glm::ivec3> centres(num_objects), moved(num_objects);
+	for(int l=0; l<num_objects; ++l)
+	{
+		centres[l] = glm::ivec3(x(generator), y(generator), z(generator));
+		moved[l] = glm::ivec3(centres[l].x+step(generator), centres[l].y+step(generator), centres[l].z+step(generator));
+	}
+	elib::Image<int> frame1 = spheres(dimensions, centres, radius),
+		frame2 = spheres(dimensions, moved, radius);
+
+	auto now = []()
+	{
+		return std::chrono::steady_clock::now();
+	};
+	auto milliseconds = [](std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end-start).count();
+	};
+
+	// reference pairs of a pixel scan
+	std::set<std::pair<int,int>> reference;
+	long long voxels = 0;
+	for(std::size_t i=0; i<std::size_t(frame1.getFlattenedLength()); ++i)
+	{
+		int a = frame1.getData()[i], b = frame2.getData()[i];
+		voxels += a > 0;
+		if(a > 0 && b > 0)
+			reference.insert(std::make_pair(a, b));
+	}
+
+	auto start = now();
+	std::map<int, elib::Mask<glm::ivec3>> points1 = pointMasks(frame1), points2 = pointMasks(frame2);
+	auto built = now();
+	std::set<std::pair<int,int>> mask_pairs;
+	for(auto &a : points1)
+	{
+		for(auto &b : points2)
+		{
+			if(a.second.overlap(b.second))
+				mask_pairs.insert(std::make_pair(a.first, b.first));
+		}
+	}
+	auto compared = now();
+	double mask_build_ms = milliseconds(start, built), mask_overlap_ms = milliseconds(built, compared);
+
+	start = now();
+	std::unordered_map<int, RunLengthMask> runs1 = RunLengthMask::fromLabelImage(frame1),
+		runs2 = RunLengthMask::fromLabelImage(frame2);
+	built = now();
+	std::set<std::pair<int,int>> run_pairs;
+	for(auto &a : runs1)
+	{
+		for(auto &b : runs2)
+		{
+			if(a.second.overlap(b.second))
+				run_pairs.insert(std::make_pair(a.first, b.first));
+		}
+	}
+	compared = now();
+	double run_build_ms = milliseconds(start, built), run_overlap_ms = milliseconds(built, compared);
+
+	long long point_bytes = 0, run_bytes = 0, num_runs = 0;
+	for(auto &mask : points1)
+	{
+		point_bytes += mask.second.getSize()*sizeof(glm::ivec3);
+	}
+	for(auto &mask : runs1)
+	{
+		run_bytes += mask.second.getNumberOfRuns()*sizeof(RunLengthMask::Run);
+		num_runs += mask.second.getNumberOfRuns();
+	}
+
+	// negation of the first object through Mask, against the image
+	bool negation_valid = true;
+	if(!points1.empty())
+	{
+		const elib::Mask<glm::ivec3> &mask = points1.begin()->second;
+		elib::Mask<glm::ivec3> negated = elib::Mask<glm::ivec3>::negate(mask);
+		negation_valid = negated.getSize() + mask.getSize() == frame1.getFlattenedLength();
+		for(const glm::ivec3 &p : *negated.getPoints())
+		{
+			negation_valid &= frame1.getData()[p.x + (p.y + std::size_t(p.z)*height)*width] != points1.begin()->first;
+		}
+	}
+
+	std::printf("%d objects in %dx%dx%d, %lld voxels, %lld runs\n", int(points1.size()), width, height, depth, voxels, num_runs);
+	std::printf("points: %6.2f bytes/voxel, build %8.2f ms, %zu overlap tests %8.2f ms\n", double(point_bytes)/voxels,
+			mask_build_ms, points1.size()*points2.size(), mask_overlap_ms);
+	std::printf("runs:   %6.2f bytes/voxel, build %8.2f ms, %zu overlap tests %8.2f ms\n", double(run_bytes)/voxels,
+			run_build_ms, runs1.size()*runs2.size(), run_overlap_ms);
+	std::printf("overlapping pairs: %zu reference, %zu points, %zu runs, negation %s\n", reference.size(), mask_pairs.size(),
+			run_pairs.size(), negation_valid ? "valid" : "INVALID");
+	return mask_pairs == reference && run_pairs == reference && negation_valid ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/*
+ * optimizer_trace.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Energy against wall time after every cycle of the multi label graph cut with the SWAP and EXPANSION
+ * optimizers, in the fixed and in a random label order, on noisy disks that moved slightly since the previous
+ * labeling. Prints one line per cycle of MultiLabelGraphcut::getTrace.
+ *
+ * usage: optimizer_trace [width labels cycles threads]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "alg/multi_label_graphcut.hpp"
+#include "templates/image.hpp"
+#include "utilities/parameters.hpp"
+
+int main(int argc, char **argv)
+{
+	typedef elib::MultiLabelGraphcut::optimizer_type optimizer_type;
+	int width = argc > 1 ? std::atoi(argv[1]) : 256,
+		num_labels = argc > 2 ? std::atoi(argv[2]) : 30,
+		max_cycles = argc > 3 ? std::atoi(argv[3]) : 0,
+		num_threads = argc > 4 ? std::atoi(argv[4]) : 0;
+
+	// the labels 2.. on disks in a grid of square cells, the intensities show the disks slightly moved
+	std::vector<int> dimensions = {width, width};
+	elib::Image<int> labels(2, dimensions, 16, 1), input(2, dimensions, 8, 1);
+	int side = 1;
+	while(side*side < num_labels-2)
+		++side;
+	int cell = width/side;
+	std::mt19937 generator(1);
+	std::normal_distribution<double> noise(0, 20);
+	for(int y=0; y<width; ++y)
+	{
+		for(int x=0; x<width; ++x)
+		{
+			int id = (y/cell)*side + x/cell;
+			double dx = x%cell - cell/2., dy = y%cell - cell/2.;
+			bool previous = id < num_labels-2 && dx*dx + dy*dy < cell*cell/9.,
+				moved = id < num_labels-2 && (dx-2)*(dx-2) + (dy+1)*(dy+1) < cell*cell/9.;
+			labels.getData()[x + y*width] = previous ? id+2 : 0;
+			input.getData()[x + y*width] = std::max(0, std::min(255, int((moved ? 180 : 40) + noise(generator))));
+		}
+	}
+
+	std::printf("%dx%d, %d labels\n", width, width, num_labels);
+	std::printf("%-10s %-7s %6s %16s %12s\n", "optimizer", "order", "cycle", "energy", "ms");
+	for(optimizer_type optimizer : {optimizer_type::SWAP, optimizer_type::EXPANSION})
+	{
+		for(int random_order=0; random_order<2; ++random_order)
+		{
+			elib::Parameters parameters;
+			parameters.addParameter("NumberLabels", num_labels);
+			parameters.addParameter("C0", 0.15);
+			parameters.addParameter("C1", 0.7);
+			parameters.addParameter("Lambda", 0.3);
+			parameters.addParameter("Sigma", 0.5);
+			parameters.addParameter("Mu", 0.4);
+			parameters.addParameter("Optimizer", static_cast<int>(optimizer));
+			parameters.addParameter("RandomLabelOrder", random_order);
+			parameters.addParameter("MaxCycles", max_cycles);
+			parameters.addParameter("Threads", num_threads);
+			elib::MultiLabelGraphcut mlgc;
+			if(mlgc.multilabel_graphcut(labels, input, parameters) == nullptr)
+				return 1;
+			for(const elib::MultiLabelGraphcut::TraceEntry &entry : mlgc.getTrace())
+			{
+				std::printf("%-10s %-7s %6d %16.1f %12.1f\n", optimizer == optimizer_type::SWAP ? "SWAP" : "EXPANSION",
+						random_order ? "random" : "fixed", entry.cycle, entry.energy, entry.milliseconds);
+			}
+		}
+	}
+	return 0;
+}
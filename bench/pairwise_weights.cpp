@@ -0,0 +1,85 @@
+/*
+ * pairwise_weights.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+/*
+ * Nanoseconds per lookup of the contrast sensitive pairwise weight through PairwiseWeightTable against
+ * evaluating exp for every pair, on random intensity pairs of 8, 12 and 16 bit images. Checks that the table
+ * returns the values evaluated on the fly, which it falls back to for a bit depth outside the table.
+ *
+ * usage: pairwise_weights [pairs]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "templates/pairwise_weight_table.hpp"
+
+int main(int argc, char **argv)
+{
+	int num_pairs = argc > 1 ? std::atoi(argv[1]) : 10000000;
+	const float sigma = 0.5;
+	std::mt19937 generator(1);
+
+	auto nanoseconds = [&](std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now()-start).count()/num_pairs;
+	};
+
+	std::printf("%d pairs\n", num_pairs);
+	std::printf("%-9s %12s %12s %12s\n", "bit depth", "table", "on the fly", "exp inline");
+	long long differences = 0;
+	for(int bit_depth : {8, 12, 16})
+	{
+		int max_intensity = (1 << bit_depth)-1;
+		float scale = 1/(sigma*max_intensity*max_intensity);
+		std::uniform_int_distribution<int> intensity(0, max_intensity);
+		std::vector<int> intensities(2*std::size_t(num_pairs));
+		for(int &i : intensities)
+		{
+			i = intensity(generator);
+		}
+		auto weight = [=](int d) -> float { return std::exp(-float(d)*float(d)*scale); };
+		elib::PairwiseWeightTable<float> table(bit_depth, weight),
+			on_the_fly(elib::PairwiseWeightTable<float>::MAX_TABULATED_BIT_DEPTH+1, weight);
+
+		std::vector<float> tabulated(num_pairs), evaluated(num_pairs), inline_evaluated(num_pairs);
+		auto start = std::chrono::steady_clock::now();
+		for(int p=0; p<num_pairs; ++p)
+		{
+			tabulated[p] = table(intensities[2*p], intensities[2*p+1]);
+		}
+		double table_ns = nanoseconds(start);
+		start = std::chrono::steady_clock::now();
+		for(int p=0; p<num_pairs; ++p)
+		{
+			evaluated[p] = on_the_fly(intensities[2*p], intensities[2*p+1]);
+		}
+		double on_the_fly_ns = nanoseconds(start);
+		start = std::chrono::steady_clock::now();
+		for(int p=0; p<num_pairs; ++p)
+		{
+			inline_evaluated[p] = weight(std::abs(intensities[2*p]-intensities[2*p+1]));
+		}
+		double inline_ns = nanoseconds(start);
+
+		for(int p=0; p<num_pairs; ++p)
+		{
+			differences += tabulated[p] != evaluated[p] || tabulated[p] != inline_evaluated[p];
+		}
+		std::printf("%-9d %9.2f ns %9.2f ns %9.2f ns\n", bit_depth, table_ns, on_the_fly_ns, inline_ns);
+	}
+
+	// bit depths outside the table must not shift by a negative or too large amount
+	elib::PairwiseWeightTable<float> negative(-1, [](int d) -> float { return float(d); });
+	differences += negative(3, 10) != 7;
+	std::printf("weights differing from the evaluation on the fly: %lld\n", differences);
+	return differences == 0 ? 0 : 1;
+}
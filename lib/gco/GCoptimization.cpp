@@ -5,6 +5,7 @@
 #include "LinkedBlockList.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <vector>
 #include <algorithm>
 
@@ -233,79 +234,6 @@ void GCoptimization::specializeDataCostFunctor(const UserFunctor f) {
 	m_solveSpecialCases         = &GCoptimization::solveSpecialCases<UserFunctor>;
 }
 
-template <typename UserFunctor>
-void GCoptimization::specializeSmoothCostFunctor(const UserFunctor f) {
-	if ( m_smoothcostFnDelete )
-		m_smoothcostFnDelete(m_smoothcostFn);
-	if ( m_smoothcostIndividual )
-	{
-		delete [] m_smoothcostIndividual;
-		m_smoothcostIndividual = 0;
-	}
-	m_smoothcostFn = new UserFunctor(f);
-	m_smoothcostFnDelete        = &GCoptimization::deleteFunctor<UserFunctor>;
-	m_giveSmoothEnergyInternal  = &GCoptimization::giveSmoothEnergyInternal<UserFunctor>;
-	m_setupSmoothCostsExpansion = &GCoptimization::setupSmoothCostsExpansion<UserFunctor>;
-	m_setupSmoothCostsSwap      = &GCoptimization::setupSmoothCostsSwap<UserFunctor>;
-}
-
-//-------------------------------------------------------------------
-
-template <typename SmoothCostT>
-GCoptimization::EnergyType GCoptimization::giveSmoothEnergyInternal()
-{
-	EnergyType eng = (EnergyType) 0;
-	SiteID i,numN,*nPointer,nSite,n;
-	EnergyTermType *weights;
-	SmoothCostT* sc = (SmoothCostT*) m_smoothcostFn;
-	for ( i = 0; i < m_num_sites; i++ )
-	{
-		giveNeighborInfo(i,&numN,&nPointer,&weights);
-		for ( n = 0; n < numN; n++ )
-		{
-			nSite = nPointer[n];
-			if ( nSite < i ) 
-				eng += weights[n]*(sc->compute(i,nSite,m_labeling[i],m_labeling[nSite]));
-		}
-	}
-
-	return eng;
-}
-
-//-------------------------------------------------------------------
-
-OLGA_INLINE void GCoptimization::addterm1_checked(EnergyT* e, VarID i, EnergyTermType e0, EnergyTermType e1)
-{
-	if ( e0 > GCO_MAX_ENERGYTERM || e1 > GCO_MAX_ENERGYTERM )
-		handleError("Data cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
-	m_beforeExpansionEnergy += e1;
-	e->add_term1(i,e0,e1);
-}
-
-OLGA_INLINE void GCoptimization::addterm1_checked(EnergyT* e, VarID i, EnergyTermType e0, EnergyTermType e1, EnergyTermType w)
-{
-	if ( e0 > GCO_MAX_ENERGYTERM || e1 > GCO_MAX_ENERGYTERM )
-		handleError("Smooth cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
-	if ( w > GCO_MAX_ENERGYTERM )
-		handleError("Smoothness weight was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
-	m_beforeExpansionEnergy += e1*w;
-	e->add_term1(i,e0*w,e1*w);
-}
-
-OLGA_INLINE void GCoptimization::addterm2_checked(EnergyT* e, VarID i, VarID j, EnergyTermType e00, EnergyTermType e01, EnergyTermType e10, EnergyTermType e11, EnergyTermType w)
-{
-	if ( e00 > GCO_MAX_ENERGYTERM || e11 > GCO_MAX_ENERGYTERM || e01 > GCO_MAX_ENERGYTERM || e10 > GCO_MAX_ENERGYTERM )
-		handleError("Smooth cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
-	if ( w > GCO_MAX_ENERGYTERM )
-		handleError("Smoothness weight was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
-	// Inside energy/maxflow code the submodularity check is performed as an assertion,
-	// but is optimized out. We check it in release builds as well.
-	if ( e00+e11 > e01+e10 )
-		handleError("Non-submodular expansion term detected; smooth costs must be a metric for expansion");
-	m_beforeExpansionEnergy += e11*w;
-	e->add_term2(i,j,e00*w,e01*w,e10*w,e11*w);
-}
-
 //------------------------------------------------------------------
 
 template <typename DataCostT>
@@ -330,35 +258,6 @@ void GCoptimization::setupDataCostsExpansion(SiteID size,LabelID alpha_label,Ene
 
 //-------------------------------------------------------------------
 
-template <typename SmoothCostT>
-void GCoptimization::setupSmoothCostsExpansion(SiteID size,LabelID alpha_label,EnergyT *e,SiteID *activeSites)
-{
-	SiteID i,nSite,site,n,nNum,*nPointer;
-	EnergyTermType *weights;
-	SmoothCostT* sc = (SmoothCostT*)m_smoothcostFn;
-
-	for ( i = size - 1; i >= 0; i-- )
-	{
-		site = activeSites[i];
-		giveNeighborInfo(site,&nNum,&nPointer,&weights);
-		for ( n = 0; n < nNum; n++ )
-		{
-			nSite = nPointer[n];
-			if ( m_lookupSiteVar[nSite] == -1 ) 
-				addterm1_checked(e,i,sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
-				                     sc->compute(site,nSite,m_labeling[site],m_labeling[nSite]),weights[n]);
-			else if ( nSite < site ) 
-			{
-				addterm2_checked(e,i,m_lookupSiteVar[nSite],
-				                 sc->compute(site,nSite,alpha_label,alpha_label),
-				                 sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
-				                 sc->compute(site,nSite,m_labeling[site],alpha_label),
-				                 sc->compute(site,nSite,m_labeling[site],m_labeling[nSite]),weights[n]);
-			}
-		}
-	}
-}
-
 //-----------------------------------------------------------------------------------
 
 template <typename DataCostT>
@@ -375,36 +274,6 @@ void GCoptimization::setupDataCostsSwap(SiteID size, LabelID alpha_label, LabelI
 
 //-------------------------------------------------------------------
 
-template <typename SmoothCostT>
-void GCoptimization::setupSmoothCostsSwap(SiteID size, LabelID alpha_label,LabelID beta_label,
-										 EnergyT *e,SiteID *activeSites )
-{
-	SiteID i,nSite,site,n,nNum,*nPointer;
-	EnergyTermType *weights;
-	SmoothCostT* sc = (SmoothCostT*)m_smoothcostFn;
-
-	for ( i = size - 1; i >= 0; i-- )
-	{
-		site = activeSites[i];
-		giveNeighborInfo(site,&nNum,&nPointer,&weights);
-		for ( n = 0; n < nNum; n++ )
-		{
-			nSite = nPointer[n];
-			if ( m_lookupSiteVar[nSite] == -1 )
-				addterm1_checked(e,i,sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
-				                     sc->compute(site,nSite,beta_label, m_labeling[nSite]),weights[n]);
-			else if ( nSite < site )
-			{
-				addterm2_checked(e,i,m_lookupSiteVar[nSite],
-				                 sc->compute(site,nSite,alpha_label,alpha_label),
-				                 sc->compute(site,nSite,alpha_label,beta_label),
-				                 sc->compute(site,nSite,beta_label,alpha_label),
-				                 sc->compute(site,nSite,beta_label,beta_label),weights[n]);
-			}
-		}
-	}
-}
-
 //-----------------------------------------------------------------------------------
 
 template <typename DataCostT>
@@ -1258,6 +1127,67 @@ bool GCoptimization::alpha_expansion(LabelID alpha_label)
 
 //-------------------------------------------------------------------
 
+bool GCoptimization::alpha_expansion(LabelID alpha_label, const SiteID *sites, SiteID size)
+{
+	assert( alpha_label >= 0 && alpha_label < m_num_labels );
+	if ( m_labelcostsAll )
+		handleError("Label costs only implemented for alpha-expansion on all sites.");
+
+	finalizeNeighbors();
+	gcoclock_t ticks0 = gcoclock();
+
+	if ( m_stepsThisCycleTotal == 0 )
+		m_labelingInfoDirty = true;
+	updateLabelingInfo();
+
+	// The active sites are the given ones not labeled alpha yet; all other sites 
+	// keep their labels and only enter through the smooth costs
+	SiteID active_size = 0;
+	SiteID *activeSites = new SiteID[size > 0 ? size : 1];
+	EnergyType afterExpansionEnergy = 0;
+	try
+	{
+		for ( SiteID i = 0; i < size; i++ )
+			if ( m_labeling[sites[i]] != alpha_label )
+				activeSites[active_size++] = sites[i];
+		if ( active_size == 0 )
+		{
+			delete [] activeSites;
+			printStatus2(alpha_label,-1,active_size,ticks0);
+			return false;
+		}
+
+		for ( SiteID i = 0; i < active_size; i++ )
+			m_lookupSiteVar[activeSites[i]] = i;
+
+		EnergyT e(active_size,m_numNeighborsTotal,(void(*)(char*))handleError);
+		e.add_variable(active_size);
+		m_beforeExpansionEnergy = 0;
+		if ( m_setupDataCostsExpansion   ) (this->*m_setupDataCostsExpansion  )(active_size,alpha_label,&e,activeSites);
+		if ( m_setupSmoothCostsExpansion ) (this->*m_setupSmoothCostsExpansion)(active_size,alpha_label,&e,activeSites);
+		checkInterrupt();
+		afterExpansionEnergy = e.minimize();
+		checkInterrupt();
+
+		if ( afterExpansionEnergy < m_beforeExpansionEnergy )
+			(this->*m_applyNewLabeling)(&e,activeSites,active_size,alpha_label);
+
+		for ( SiteID i = 0; i < active_size; i++ )
+			m_lookupSiteVar[activeSites[i]] = -1; // restore m_lookupSite to all -1s
+
+		printStatus2(alpha_label,-1,active_size,ticks0);
+	}
+	catch (...)
+	{
+		delete [] activeSites;
+		throw;
+	}
+	delete [] activeSites;
+	return afterExpansionEnergy < m_beforeExpansionEnergy;
+}
+
+//-------------------------------------------------------------------
+
 GCoptimization::EnergyType GCoptimization::oneExpansionIteration()
 {
 	permuteLabelTable();
@@ -1390,6 +1320,65 @@ void GCoptimization::alpha_beta_swap(LabelID alpha_label, LabelID beta_label)
 }
 
 
+//---------------------------------------------------------------------------------
+
+void GCoptimization::alpha_beta_swap(LabelID alpha_label, LabelID beta_label, SiteID *alphaSites, 
+		                 SiteID alpha_size, SiteID *betaSites, SiteID beta_size)
+{
+	assert( alpha_label >= 0 && alpha_label < m_num_labels && beta_label >= 0 && beta_label < m_num_labels);
+	if ( m_labelcostsAll )
+		handleError("Label costs only implemented for alpha-expansion.");
+
+	finalizeNeighbors();
+	gcoclock_t ticks0 = gcoclock();
+
+	// The active sites are the given ones, which have to carry alpha_label and beta_label;
+	// all other sites keep their labels and only enter through the smooth costs
+	SiteID size = alpha_size + beta_size;
+	if ( size == 0 )
+	{
+		printStatus2(alpha_label,beta_label,size,ticks0);
+		return;
+	}
+	SiteID *activeSites = new SiteID[size];
+	try
+	{
+		for ( SiteID i = 0; i < alpha_size; i++ )
+			activeSites[i] = alphaSites[i];
+		for ( SiteID i = 0; i < beta_size; i++ )
+			activeSites[alpha_size+i] = betaSites[i];
+		for ( SiteID i = 0; i < size; i++ )
+		{
+			assert( m_labeling[activeSites[i]] == (i < alpha_size ? alpha_label : beta_label) );
+			m_lookupSiteVar[activeSites[i]] = i;
+		}
+
+		EnergyT e(size,m_numNeighborsTotal,(void(*)(char*))handleError);
+		e.add_variable(size);
+		if ( m_setupDataCostsSwap   ) (this->*m_setupDataCostsSwap  )(size,alpha_label,beta_label,&e,activeSites);
+		if ( m_setupSmoothCostsSwap ) (this->*m_setupSmoothCostsSwap)(size,alpha_label,beta_label,&e,activeSites);
+		checkInterrupt();
+		e.minimize();
+		checkInterrupt();
+
+		// Apply the new labeling
+		for ( SiteID i = 0; i < size; i++ )
+		{
+			m_labeling[activeSites[i]] = (e.get_var(i) == 0) ? alpha_label : beta_label;
+			m_lookupSiteVar[activeSites[i]] = -1; // restore lookupSiteVar to all -1s
+		}
+		m_labelingInfoDirty = true;
+	} 
+	catch (...)
+	{
+		delete [] activeSites;
+		throw;
+	}
+	delete [] activeSites;
+
+	printStatus2(alpha_label,beta_label,size,ticks0);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for the GCoptimizationGridGraph, derived from GCoptimization
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1514,6 +1503,93 @@ void GCoptimizationGridGraph::computeNeighborWeights(EnergyTermType *vCosts,Ener
 	}
 
 }
+////////////////////////////////////////////////////////////////////////////////////////////////
+// Functions for the GCoptimizationGridGraph3D, derived from GCoptimization
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+GCoptimizationGridGraph3D::GCoptimizationGridGraph3D(SiteID width, SiteID height, SiteID depth,
+													 LabelID num_labels, int neighborhood)
+						:GCoptimization(width*height*depth,num_labels)
+{
+	assert( (width > 1) && (height > 1) && (depth > 1) && (num_labels > 1) );
+	if ( neighborhood != 6 && neighborhood != 18 && neighborhood != 26 )
+		handleError("The neighborhood of a 3D grid graph has to be 6, 18 or 26.");
+
+	m_width  = width;
+	m_height = height;
+	m_depth  = depth;
+	m_numNeighbors = 0;
+
+	// offsets with at most 1, 2 or 3 nonzero coordinates
+	int maxNonzero = neighborhood == 6 ? 1 : (neighborhood == 18 ? 2 : 3);
+	m_numOffsets = 0;
+	for ( int dz = -1; dz <= 1; dz++ )
+		for ( int dy = -1; dy <= 1; dy++ )
+			for ( int dx = -1; dx <= 1; dx++ )
+			{
+				int nonzero = (dx != 0) + (dy != 0) + (dz != 0);
+				if ( nonzero == 0 || nonzero > maxNonzero )
+					continue;
+				m_offsets[m_numOffsets][0] = dx;
+				m_offsets[m_numOffsets][1] = dy;
+				m_offsets[m_numOffsets][2] = dz;
+				m_offsetIndexes[m_numOffsets] = dx+dy*m_width+dz*m_width*m_height;
+				m_offsetWeights[m_numOffsets] = (EnergyTermType)(1/sqrt((double)nonzero));
+				m_numOffsets++;
+			}
+
+	// every neighbor inside the grid is counted once for each of both sites
+	for ( int n = 0; n < m_numOffsets; n++ )
+		m_numNeighborsTotal += (m_width-abs(m_offsets[n][0]))*(m_height-abs(m_offsets[n][1]))*(m_depth-abs(m_offsets[n][2]));
+}
+
+//-------------------------------------------------------------------
+
+GCoptimizationGridGraph3D::~GCoptimizationGridGraph3D()
+{
+}
+
+//-------------------------------------------------------------------
+
+void GCoptimizationGridGraph3D::finalizeNeighbors()
+{
+}
+
+//-------------------------------------------------------------------
+
+void GCoptimizationGridGraph3D::giveNeighborInfo(SiteID site, SiteID *numSites, SiteID **neighbors, EnergyTermType **weights)
+{
+	SiteID x = site%m_width,
+	       y = (site/m_width)%m_height,
+	       z = site/(m_width*m_height);
+
+	if ( x > 0 && x < m_width-1 && y > 0 && y < m_height-1 && z > 0 && z < m_depth-1 )
+	{
+		for ( int n = 0; n < m_numOffsets; n++ )
+			m_interiorNeighbors[n] = site+m_offsetIndexes[n];
+		*numSites  = m_numOffsets;
+		*neighbors = m_interiorNeighbors;
+		*weights   = m_offsetWeights;
+		return;
+	}
+
+	SiteID count = 0;
+	for ( int n = 0; n < m_numOffsets; n++ )
+	{
+		SiteID nx = x+m_offsets[n][0],
+		       ny = y+m_offsets[n][1],
+		       nz = z+m_offsets[n][2];
+		if ( nx < 0 || nx >= m_width || ny < 0 || ny >= m_height || nz < 0 || nz >= m_depth )
+			continue;
+		m_neighborBuffer[count] = site+m_offsetIndexes[n];
+		m_weightBuffer[count]   = m_offsetWeights[n];
+		count++;
+	}
+	*numSites  = count;
+	*neighbors = m_neighborBuffer;
+	*weights   = m_weightBuffer;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for the GCoptimizationGeneralGraph, derived from GCoptimization
 ////////////////////////////////////////////////////////////////////////////////////////////////////
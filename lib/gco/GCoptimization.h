@@ -177,6 +177,10 @@ public:
 	// Peforms  expansion on one label, specified by the input parameter alpha_label 
 	bool alpha_expansion(LabelID alpha_label);
 
+	// Peforms  expansion on one label, specified by the input parameter alpha_label, only on the 
+	// sites in the array sites of size size; sites outside keep their labels                       
+	bool alpha_expansion(LabelID alpha_label, const SiteID *sites, SiteID size);
+
 	// Peforms swap algorithm. Runs it the specified number of iterations. If no  
 	// input is specified,runs until convergence                                  
 	EnergyType swap(int max_num_iterations=-1);
@@ -217,6 +221,10 @@ public:
 	void setSmoothCost(LabelID l1, LabelID l2, EnergyTermType e); 
 	void setSmoothCost(EnergyTermType *smoothArray);
 	void setSmoothCostFunctor(SmoothCostFunctor* f);
+	// Sets the smooth costs to a copy of f, any class with a member function          
+	// EnergyTermType compute(SiteID s1, SiteID s2, LabelID l1, LabelID l2). The moves are    
+	// instantiated for the class, so unlike the callbacks above compute can be inlined       
+	template <typename UserFunctor> void setSmoothCostInline(const UserFunctor &f) { specializeSmoothCostFunctor(f); }
 	struct SmoothCostFunctor {
 		virtual EnergyTermType compute(SiteID s1, SiteID s2, LabelID l1, LabelID l2) = 0;
 	};
@@ -543,6 +551,36 @@ private:
 	void computeNeighborWeights(EnergyTermType *vCosts,EnergyTermType *hCosts);
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Use this derived class for 3D grid graphs. The neighbors of a site are computed from its       
+// position when asked for, so no neighbor arrays are stored. The neighborhood is 6 (faces),       
+// 18 (faces and edges) or 26 (faces, edges and corners) connected; neighbors are weighted by the 
+// inverse of their distance                                                                      
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+class GCoptimizationGridGraph3D: public GCoptimization
+{
+public:
+	GCoptimizationGridGraph3D(SiteID width,SiteID height,SiteID depth,LabelID num_labels,int neighborhood=6);
+	virtual ~GCoptimizationGridGraph3D();
+
+protected:
+	virtual void giveNeighborInfo(SiteID site, SiteID *numSites, SiteID **neighbors, EnergyTermType **weights);
+	virtual void finalizeNeighbors();
+
+private:
+	SiteID m_width;
+	SiteID m_height;
+	SiteID m_depth;
+	int m_numOffsets;
+	int m_offsets[26][3];                   // x, y and z offset of each neighbor
+	SiteID m_offsetIndexes[26];             // site offset of each neighbor
+	EnergyTermType m_offsetWeights[26];     // weight of each neighbor
+	SiteID m_neighborBuffer[26];            // neighbors of the last site asked for at the border
+	EnergyTermType m_weightBuffer[26];
+	SiteID m_interiorNeighbors[26];         // neighbors of the last interior site asked for
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
 class GCoptimizationGeneralGraph:public GCoptimization
@@ -590,6 +628,147 @@ private:
 // Methods
 ////////////////////////////////////////////////////////////////////
 
+//-------------------------------------------------------------------
+// Smooth cost setup, in the header so setSmoothCostInline can be 
+// instantiated with functors of the caller
+//-------------------------------------------------------------------
+
+OLGA_INLINE void GCoptimization::addterm1_checked(EnergyT* e, VarID i, EnergyTermType e0, EnergyTermType e1)
+{
+	if ( e0 > GCO_MAX_ENERGYTERM || e1 > GCO_MAX_ENERGYTERM )
+		handleError("Data cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
+	m_beforeExpansionEnergy += e1;
+	e->add_term1(i,e0,e1);
+}
+
+OLGA_INLINE void GCoptimization::addterm1_checked(EnergyT* e, VarID i, EnergyTermType e0, EnergyTermType e1, EnergyTermType w)
+{
+	if ( e0 > GCO_MAX_ENERGYTERM || e1 > GCO_MAX_ENERGYTERM )
+		handleError("Smooth cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
+	if ( w > GCO_MAX_ENERGYTERM )
+		handleError("Smoothness weight was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
+	m_beforeExpansionEnergy += e1*w;
+	e->add_term1(i,e0*w,e1*w);
+}
+
+OLGA_INLINE void GCoptimization::addterm2_checked(EnergyT* e, VarID i, VarID j, EnergyTermType e00, EnergyTermType e01, EnergyTermType e10, EnergyTermType e11, EnergyTermType w)
+{
+	if ( e00 > GCO_MAX_ENERGYTERM || e11 > GCO_MAX_ENERGYTERM || e01 > GCO_MAX_ENERGYTERM || e10 > GCO_MAX_ENERGYTERM )
+		handleError("Smooth cost term was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
+	if ( w > GCO_MAX_ENERGYTERM )
+		handleError("Smoothness weight was larger than GCO_MAX_ENERGYTERM; danger of integer overflow.");
+	// Inside energy/maxflow code the submodularity check is performed as an assertion,
+	// but is optimized out. We check it in release builds as well.
+	if ( e00+e11 > e01+e10 )
+		handleError("Non-submodular expansion term detected; smooth costs must be a metric for expansion");
+	m_beforeExpansionEnergy += e11*w;
+	e->add_term2(i,j,e00*w,e01*w,e10*w,e11*w);
+}
+
+//-------------------------------------------------------------------
+
+template <typename UserFunctor>
+void GCoptimization::specializeSmoothCostFunctor(const UserFunctor f) {
+	if ( m_smoothcostFnDelete )
+		m_smoothcostFnDelete(m_smoothcostFn);
+	if ( m_smoothcostIndividual )
+	{
+		delete [] m_smoothcostIndividual;
+		m_smoothcostIndividual = 0;
+	}
+	m_smoothcostFn = new UserFunctor(f);
+	m_smoothcostFnDelete        = &GCoptimization::deleteFunctor<UserFunctor>;
+	m_giveSmoothEnergyInternal  = &GCoptimization::giveSmoothEnergyInternal<UserFunctor>;
+	m_setupSmoothCostsExpansion = &GCoptimization::setupSmoothCostsExpansion<UserFunctor>;
+	m_setupSmoothCostsSwap      = &GCoptimization::setupSmoothCostsSwap<UserFunctor>;
+}
+
+//-------------------------------------------------------------------
+
+template <typename SmoothCostT>
+GCoptimization::EnergyType GCoptimization::giveSmoothEnergyInternal()
+{
+	EnergyType eng = (EnergyType) 0;
+	SiteID i,numN,*nPointer,nSite,n;
+	EnergyTermType *weights;
+	SmoothCostT* sc = (SmoothCostT*) m_smoothcostFn;
+	for ( i = 0; i < m_num_sites; i++ )
+	{
+		giveNeighborInfo(i,&numN,&nPointer,&weights);
+		for ( n = 0; n < numN; n++ )
+		{
+			nSite = nPointer[n];
+			if ( nSite < i ) 
+				eng += weights[n]*(sc->compute(i,nSite,m_labeling[i],m_labeling[nSite]));
+		}
+	}
+
+	return eng;
+}
+
+//-------------------------------------------------------------------
+
+template <typename SmoothCostT>
+void GCoptimization::setupSmoothCostsExpansion(SiteID size,LabelID alpha_label,EnergyT *e,SiteID *activeSites)
+{
+	SiteID i,nSite,site,n,nNum,*nPointer;
+	EnergyTermType *weights;
+	SmoothCostT* sc = (SmoothCostT*)m_smoothcostFn;
+
+	for ( i = size - 1; i >= 0; i-- )
+	{
+		site = activeSites[i];
+		giveNeighborInfo(site,&nNum,&nPointer,&weights);
+		for ( n = 0; n < nNum; n++ )
+		{
+			nSite = nPointer[n];
+			if ( m_lookupSiteVar[nSite] == -1 ) 
+				addterm1_checked(e,i,sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
+				                     sc->compute(site,nSite,m_labeling[site],m_labeling[nSite]),weights[n]);
+			else if ( nSite < site ) 
+			{
+				addterm2_checked(e,i,m_lookupSiteVar[nSite],
+				                 sc->compute(site,nSite,alpha_label,alpha_label),
+				                 sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
+				                 sc->compute(site,nSite,m_labeling[site],alpha_label),
+				                 sc->compute(site,nSite,m_labeling[site],m_labeling[nSite]),weights[n]);
+			}
+		}
+	}
+}
+
+//-------------------------------------------------------------------
+
+template <typename SmoothCostT>
+void GCoptimization::setupSmoothCostsSwap(SiteID size, LabelID alpha_label,LabelID beta_label,
+										 EnergyT *e,SiteID *activeSites )
+{
+	SiteID i,nSite,site,n,nNum,*nPointer;
+	EnergyTermType *weights;
+	SmoothCostT* sc = (SmoothCostT*)m_smoothcostFn;
+
+	for ( i = size - 1; i >= 0; i-- )
+	{
+		site = activeSites[i];
+		giveNeighborInfo(site,&nNum,&nPointer,&weights);
+		for ( n = 0; n < nNum; n++ )
+		{
+			nSite = nPointer[n];
+			if ( m_lookupSiteVar[nSite] == -1 )
+				addterm1_checked(e,i,sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
+				                     sc->compute(site,nSite,beta_label, m_labeling[nSite]),weights[n]);
+			else if ( nSite < site )
+			{
+				addterm2_checked(e,i,m_lookupSiteVar[nSite],
+				                 sc->compute(site,nSite,alpha_label,alpha_label),
+				                 sc->compute(site,nSite,alpha_label,beta_label),
+				                 sc->compute(site,nSite,beta_label,alpha_label),
+				                 sc->compute(site,nSite,beta_label,beta_label),weights[n]);
+			}
+		}
+	}
+}
+
 
 OLGA_INLINE GCoptimization::SiteID GCoptimization::numSites() const
 {
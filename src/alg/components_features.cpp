@@ -0,0 +1,257 @@
+/*
+ * components_features.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "components_features.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include "templates/image.hpp"
+#include "templates/image_view.hpp"
+#include "utilities/parallel.hpp"
+
+namespace elib{
+
+namespace
+{
+
+struct Accumulator
+{
+	long long area = 0;
+	double sum[3] = {0, 0, 0},
+		products[6] = {0, 0, 0, 0, 0, 0};	/* xx, yy, zz, xy, xz, yz */
+	int min[3] = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), std::numeric_limits<int>::max()},
+		max[3] = {std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), std::numeric_limits<int>::min()};
+	double intensity_sum = 0,
+		intensity_min = std::numeric_limits<double>::infinity(),
+		intensity_max = -std::numeric_limits<double>::infinity();
+
+	inline void add(int x, int y, int z)
+	{
+		++area;
+		sum[0] += x;
+		sum[1] += y;
+		sum[2] += z;
+		products[0] += double(x)*x;
+		products[1] += double(y)*y;
+		products[2] += double(z)*z;
+		products[3] += double(x)*y;
+		products[4] += double(x)*z;
+		products[5] += double(y)*z;
+		int p[3] = {x, y, z};
+		for(int i=0; i<3; ++i)
+		{
+			min[i] = std::min(min[i], p[i]);
+			max[i] = std::max(max[i], p[i]);
+		}
+	}
+	inline void addIntensity(double intensity)
+	{
+		intensity_sum += intensity;
+		intensity_min = std::min(intensity_min, intensity);
+		intensity_max = std::max(intensity_max, intensity);
+	}
+	void merge(const Accumulator &other)
+	{
+		area += other.area;
+		for(int i=0; i<3; ++i)
+		{
+			sum[i] += other.sum[i];
+			min[i] = std::min(min[i], other.min[i]);
+			max[i] = std::max(max[i], other.max[i]);
+		}
+		for(int i=0; i<6; ++i)
+		{
+			products[i] += other.products[i];
+		}
+		intensity_sum += other.intensity_sum;
+		intensity_min = std::min(intensity_min, other.intensity_min);
+		intensity_max = std::max(intensity_max, other.intensity_max);
+	}
+};
+
+} /* end anonymous namespace */
+
+ComponentsFeatures::ComponentsFeatures()
+{
+}
+
+ComponentsFeatures::~ComponentsFeatures()
+{
+}
+
+template <typename LabelImage>
+bool ComponentsFeatures::measure(const LabelImage &label_image)
+{
+	return accumulate(label_image, static_cast<const LabelImage*>(nullptr));
+}
+
+template <typename LabelImage, typename IntensityImage>
+bool ComponentsFeatures::measure(const LabelImage &label_image, const IntensityImage &intensity_image)
+{
+	if(*label_image.getDimensions() != *intensity_image.getDimensions())
+		return false;
+	return accumulate(label_image, &intensity_image);
+}
+
+template <typename LabelImage, typename IntensityImage>
+bool ComponentsFeatures::accumulate(const LabelImage &label_image, const IntensityImage *intensity_image)
+{
+	int width = label_image.getWidth(),
+		height = label_image.getHeight(),
+		depth = label_image.getDepth(),
+		plane_size = depth > 1 ? width*height : width,
+		num_planes = depth > 1 ? depth : height,
+		num_slabs = std::max(1, std::min(num_threads > 0 ? num_threads : defaultNumberOfThreads(), num_planes));
+	std::vector<int> slab_begin(num_slabs+1);
+	for(int s=0; s<=num_slabs; ++s)
+	{
+		slab_begin[s] = int((long long)num_planes*s/num_slabs);
+	}
+
+	/****** Map the labels present to dense slots *************************/
+	// labels are read at the width of the storage, so 64 bit labels are neither narrowed nor merged
+	auto labelAt = [&](std::size_t pixel)
+	{
+		return (long long)label_image.getData()[pixel];
+	};
+	std::size_t length = std::size_t(plane_size)*num_planes;
+	std::vector<long long> slab_max(num_slabs, 0);
+	parallelFor(0, num_slabs, [&](int s)
+	{
+		for(std::size_t pixel=std::size_t(slab_begin[s])*plane_size; pixel<std::size_t(slab_begin[s+1])*plane_size; ++pixel)
+		{
+			slab_max[s] = std::max(slab_max[s], labelAt(pixel));
+		}
+	}, num_slabs);
+	long long max_label = *std::max_element(slab_max.begin(), slab_max.end());
+	// a remap table while it is not much larger than the image, the sorted distinct labels otherwise
+	bool use_table = max_label <= 4*(long long)length + 1024;
+	std::vector<int> slots;
+	std::vector<long long> labels;
+	if(use_table)
+	{
+		std::vector<std::atomic<int>> present(std::size_t(max_label)+1);
+		parallelFor(0, num_slabs, [&](int s)
+		{
+			for(std::size_t pixel=std::size_t(slab_begin[s])*plane_size; pixel<std::size_t(slab_begin[s+1])*plane_size; ++pixel)
+			{
+				long long label = labelAt(pixel);
+				if(label > 0)
+					present[label].store(1, std::memory_order_relaxed);
+			}
+		}, num_slabs);
+		slots.assign(present.size(), -1);
+		for(std::size_t label=1; label<present.size(); ++label)
+		{
+			if(present[label].load(std::memory_order_relaxed))
+			{
+				slots[label] = int(labels.size());
+				labels.push_back((long long)label);
+			}
+		}
+	}
+	else
+	{
+		std::vector<std::vector<long long>> slab_labels(num_slabs);
+		parallelFor(0, num_slabs, [&](int s)
+		{
+			std::vector<long long> &distinct = slab_labels[s];
+			for(std::size_t pixel=std::size_t(slab_begin[s])*plane_size; pixel<std::size_t(slab_begin[s+1])*plane_size; ++pixel)
+			{
+				long long label = labelAt(pixel);
+				if(label > 0)
+					distinct.push_back(label);
+			}
+			std::sort(distinct.begin(), distinct.end());
+			distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+		}, num_slabs);
+		for(auto &distinct : slab_labels)
+		{
+			labels.insert(labels.end(), distinct.begin(), distinct.end());
+		}
+		std::sort(labels.begin(), labels.end());
+		labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+	}
+	auto slotOf = [&](long long label)
+	{
+		if(use_table)
+			return slots[label];
+		return int(std::lower_bound(labels.begin(), labels.end(), label) - labels.begin());
+	};
+
+	/****** Accumulate per slab and reduce *************************/
+	std::vector<std::vector<Accumulator>> accumulators(num_slabs);
+	parallelFor(0, num_slabs, [&](int s)
+	{
+		std::vector<Accumulator> &slab = accumulators[s];
+		slab.resize(labels.size());
+		for(std::size_t pixel=std::size_t(slab_begin[s])*plane_size; pixel<std::size_t(slab_begin[s+1])*plane_size; ++pixel)
+		{
+			long long label = labelAt(pixel);
+			if(label > 0)
+			{
+				Accumulator &a = slab[slotOf(label)];
+				a.add(int(pixel % width), int((pixel / width) % height), int(pixel / (std::size_t(width)*height)));
+				if(intensity_image != nullptr)
+					a.addIntensity(intensity_image->get(pixel));
+			}
+		}
+	}, num_slabs);
+	for(int s=1; s<num_slabs; ++s)
+	{
+		for(std::size_t i=0; i<labels.size(); ++i)
+		{
+			accumulators[0][i].merge(accumulators[s][i]);
+		}
+	}
+
+	/****** Derive the features *************************/
+	features.assign(labels.size()*NUMBER_OF_FEATURES, 0.);
+	for(std::size_t i=0; i<labels.size(); ++i)
+	{
+		const Accumulator &a = accumulators[0][i];
+		double *row = features.data() + i*NUMBER_OF_FEATURES,
+			area = double(a.area);
+		row[LABEL] = double(labels[i]);
+		row[AREA] = area;
+		for(int d=0; d<3; ++d)
+		{
+			row[CENTROID_X+d] = a.sum[d]/area;
+			row[MIN_X+d] = a.min[d];
+			row[MAX_X+d] = a.max[d];
+		}
+		row[MOMENT_XX] = a.products[0]/area - row[CENTROID_X]*row[CENTROID_X];
+		row[MOMENT_YY] = a.products[1]/area - row[CENTROID_Y]*row[CENTROID_Y];
+		row[MOMENT_ZZ] = a.products[2]/area - row[CENTROID_Z]*row[CENTROID_Z];
+		row[MOMENT_XY] = a.products[3]/area - row[CENTROID_X]*row[CENTROID_Y];
+		row[MOMENT_XZ] = a.products[4]/area - row[CENTROID_X]*row[CENTROID_Z];
+		row[MOMENT_YZ] = a.products[5]/area - row[CENTROID_Y]*row[CENTROID_Z];
+		row[ORIENTATION] = 0.5*std::atan2(2*row[MOMENT_XY], row[MOMENT_XX] - row[MOMENT_YY]);
+		if(intensity_image != nullptr)
+		{
+			row[INTENSITY_SUM] = a.intensity_sum;
+			row[INTENSITY_MIN] = a.intensity_min;
+			row[INTENSITY_MAX] = a.intensity_max;
+			row[INTENSITY_MEAN] = a.intensity_sum/area;
+		}
+	}
+	return true;
+}
+
+template bool ComponentsFeatures::measure(const Image<int>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long long>&);
+template bool ComponentsFeatures::measure(const Image<int>&, const Image<int>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long>&, const ImageView<int, long>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long long>&, const ImageView<int, long long>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long>&, const ImageView<double, double>&);
+template bool ComponentsFeatures::measure(const ImageView<int, long long>&, const ImageView<double, double>&);
+
+} /* end namespace elib */
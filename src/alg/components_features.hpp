@@ -0,0 +1,78 @@
+/*
+ * components_features.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef COMPONENTS_FEATURES_HPP_
+#define COMPONENTS_FEATURES_HPP_
+
+#include <vector>
+
+namespace elib{
+
+/*
+ * Per-label features of a label image (labels > 0) and optionally an intensity image of the same size,
+ * accumulated in a single scan without materializing masks. Slabs of planes (z-slices, rows in 2D) are
+ * scanned concurrently into private accumulators, which are summed afterwards. Labels are mapped to
+ * dense slots, through a remap table while the largest label is within a few times the number of pixels
+ * and by binary search in the sorted distinct labels otherwise, so memory grows with the number of objects
+ * times the number of threads and labels up to 64 bit are kept apart.
+ *
+ * Features are stored row-wise, one row of NUMBER_OF_FEATURES values per object in ascending label order.
+ * Coordinates are 0-based pixel indices, z is 0 in 2D.
+ */
+class ComponentsFeatures
+{
+	public:
+		enum feature
+		{
+			LABEL,
+			AREA,
+			CENTROID_X, CENTROID_Y, CENTROID_Z,
+			MIN_X, MIN_Y, MIN_Z,
+			MAX_X, MAX_Y, MAX_Z,
+			MOMENT_XX, MOMENT_YY, MOMENT_ZZ, MOMENT_XY, MOMENT_XZ, MOMENT_YZ,	/* central second moments divided by the area */
+			ORIENTATION,	/* angle of the major axis in the xy-plane against the x-axis, in (-Pi/2, Pi/2] */
+			INTENSITY_SUM, INTENSITY_MIN, INTENSITY_MAX, INTENSITY_MEAN,	/* 0 without an intensity image */
+			NUMBER_OF_FEATURES
+		};
+
+		ComponentsFeatures();
+		virtual ~ComponentsFeatures();
+
+		/*
+		 * Instantiated for Image<int> and for views on 64 bit integer (MTensor) data, returns false if
+		 * the images differ in size
+		 */
+		template <typename LabelImage>
+		bool measure(const LabelImage &label_image);
+		template <typename LabelImage, typename IntensityImage>
+		bool measure(const LabelImage &label_image, const IntensityImage &intensity_image);
+
+		int getNumberOfObjects() const
+		{
+			return int(features.size()/NUMBER_OF_FEATURES);
+		}
+		const std::vector<double>* getFeatures() const
+		{
+			return &features;
+		}
+		/* 0 uses all hardware threads */
+		void setNumberOfThreads(int num_threads = 0)
+		{
+			this->num_threads = num_threads;
+		}
+
+	private:
+		template <typename LabelImage, typename IntensityImage>
+		bool accumulate(const LabelImage &label_image, const IntensityImage *intensity_image);
+
+		std::vector<double> features;
+		int num_threads = 0;
+};
+
+} /* end namespace elib */
+
+#endif /* COMPONENTS_FEATURES_HPP_ */
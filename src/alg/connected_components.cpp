@@ -7,18 +7,53 @@
 
 #include "connected_components.hpp"
 
+#include <algorithm>
+
 #include "glm/glm.hpp"
+#include "utilities/parallel.hpp"
 
 using elib::ConnectedComponents;
 using elib::Image;
 
 namespace elib{
 
+namespace
+{
+
+inline int findRoot(std::vector<int> &parent, int i)
+{
+	int root = i;
+	while(parent[root] != root)
+		root = parent[root];
+	while(parent[i] != root)
+	{
+		int next = parent[i];
+		parent[i] = root;
+		i = next;
+	}
+	return root;
+}
+
+/* links the larger root to the smaller one, so every root is the first pixel of its tree in scan order */
+inline int unite(std::vector<int> &parent, int i, int j)
+{
+	i = findRoot(parent, i);
+	j = findRoot(parent, j);
+	if(i < j)
+		std::swap(i, j);
+	parent[i] = j;
+	return j;
+}
+
+} /* end anonymous namespace */
+
 std::vector<glm::ivec3> ConnectedComponents::SMALL_2D({glm::ivec3(-1,0,0), glm::ivec3(0,-1,0), glm::ivec3(1,0,0), glm::ivec3(0,1,0)});
 std::vector<glm::ivec3> ConnectedComponents::LARGE_2D({glm::ivec3(-1,0,0), glm::ivec3(-1,-1,0), glm::ivec3(0,-1,0), glm::ivec3(1,-1,0), glm::ivec3(1,0,0), glm::ivec3(1,1,0), glm::ivec3(0,1,0), glm::ivec3(-1,1,0)});
 
 std::vector<glm::ivec3> ConnectedComponents::SMALL_3D({glm::ivec3(-1,0,0), glm::ivec3(0,0,-1), glm::ivec3(1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,1,0), glm::ivec3(0,-1,0)});
 std::vector<glm::ivec3> ConnectedComponents::LARGE_3D({glm::ivec3(-1,0,0), glm::ivec3(0,0,-1), glm::ivec3(1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(-1,1,-1), glm::ivec3(1,1,-1), glm::ivec3(-1,1,1), glm::ivec3(1,1,1), glm::ivec3(-1,-1,-1), glm::ivec3(1,-1,-1), glm::ivec3(-1,-1,1), glm::ivec3(1,-1,1)});
+std::vector<glm::ivec3> ConnectedComponents::EDGE_3D({glm::ivec3(-1,0,0), glm::ivec3(0,0,-1), glm::ivec3(1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(-1,-1,0), glm::ivec3(1,-1,0), glm::ivec3(-1,1,0), glm::ivec3(1,1,0), glm::ivec3(-1,0,-1), glm::ivec3(1,0,-1), glm::ivec3(-1,0,1), glm::ivec3(1,0,1), glm::ivec3(0,-1,-1), glm::ivec3(0,1,-1), glm::ivec3(0,-1,1), glm::ivec3(0,1,1)});
+std::vector<glm::ivec3> ConnectedComponents::FULL_3D({glm::ivec3(-1,0,0), glm::ivec3(0,0,-1), glm::ivec3(1,0,0), glm::ivec3(0,0,1), glm::ivec3(0,1,0), glm::ivec3(0,-1,0), glm::ivec3(-1,-1,0), glm::ivec3(1,-1,0), glm::ivec3(-1,1,0), glm::ivec3(1,1,0), glm::ivec3(-1,0,-1), glm::ivec3(1,0,-1), glm::ivec3(-1,0,1), glm::ivec3(1,0,1), glm::ivec3(0,-1,-1), glm::ivec3(0,1,-1), glm::ivec3(0,-1,1), glm::ivec3(0,1,1), glm::ivec3(-1,1,-1), glm::ivec3(1,1,-1), glm::ivec3(-1,1,1), glm::ivec3(1,1,1), glm::ivec3(-1,-1,-1), glm::ivec3(1,-1,-1), glm::ivec3(-1,-1,1), glm::ivec3(1,-1,1)});
 
 ConnectedComponents::ConnectedComponents()
 {
@@ -29,67 +64,116 @@ ConnectedComponents::~ConnectedComponents()
 	// TODO Auto-generated destructor stub
 }
 
-Image<int> ConnectedComponents::getComponents(Image<int> image)
+const std::vector<glm::ivec3>& ConnectedComponents::getNeighbours(int rank) const
+{
+	if(rank == 2)
+		return connectivity == SMALL_CONNECTIVITY ? SMALL_2D : LARGE_2D;
+	switch(connectivity)
+	{
+		case SMALL_CONNECTIVITY:
+			return SMALL_3D;
+		case EDGE_CONNECTIVITY:
+			return EDGE_3D;
+		case FULL_CONNECTIVITY:
+			return FULL_3D;
+		default:
+			return LARGE_3D;
+	}
+}
+
+Image<int> ConnectedComponents::getComponents(const Image<int> &image)
 {
-	Image<int> tmp_image = Image<int>(image);
-	int *tmp_data = tmp_image.getData();
 	Image<int> label_image = Image<int>(image.getRank(), *image.getDimensions(), 16, 1);
+	const int *data = image.getData();
 	int *label_data = label_image.getData();
 	int width = image.getWidth(),
 		height = image.getHeight(),
-		depth = image.getDepth();
-	std::queue<glm::ivec3 > indices;
-	std::vector<glm::ivec3 > *neighbours;
-	glm::ivec3 index;
-	int pixel;
+		depth = image.getDepth(),
+		num_pixels = image.getFlattenedLength();
 
-	if(connectivity == SMALL_CONNECTIVITY)
+	// neighbours preceding a pixel in scan order, the others are visited from the neighbour
+	std::vector<glm::ivec3> preceding;
+	for(const glm::ivec3 &n : getNeighbours(image.getRank()))
 	{
-		if(image.getRank() == 2)
-			neighbours = &(ConnectedComponents::SMALL_2D);
-		else
-			neighbours = &(ConnectedComponents::SMALL_3D);
+		if(n.z < 0 || (n.z == 0 && (n.y < 0 || (n.y == 0 && n.x < 0))))
+			preceding.push_back(n);
 	}
-	else
+
+	// slabs of planes, rows in 2D
+	int plane_size = depth > 1 ? width*height : width,
+		num_planes = depth > 1 ? depth : height,
+		num_slabs = std::min(num_threads > 0 ? num_threads : defaultNumberOfThreads(), num_planes);
+	std::vector<int> slab_begin(num_slabs+1);
+	for(int s=0; s<=num_slabs; ++s)
 	{
-		if(image.getRank() == 2)
-			neighbours = &(ConnectedComponents::LARGE_2D);
-		else
-			neighbours = &(ConnectedComponents::LARGE_3D);
+		slab_begin[s] = int((long long)num_planes*s/num_slabs);
 	}
-	for(int k=0; k<depth; ++k)
+
+	// first pass: provisional trees per slab, label_data marks the foreground
+	std::vector<int> parent(num_pixels);
+	auto scan = [&](int first_plane, int last_plane, int from_plane, int to_plane, bool initialize)
 	{
-		for(int j=0; j<height; ++j)
+		for(int pixel=from_plane*plane_size; pixel<to_plane*plane_size; ++pixel)
 		{
-			for(int i=0; i<width; ++i)
+			if(data[pixel] <= 0)
 			{
-				pixel = k*width*height + j*width + i;
-				if(tmp_data[pixel] > 0)
-				{
-					tmp_data[pixel] = 0;
-					label_data[pixel] = label;
-					index = glm::ivec3(i,j,k);
-					addNeigbours(&indices, neighbours, index, image.getRank(), *image.getDimensions());
-					while(!indices.empty())
-					{
-						index = indices.front();
-						indices.pop();
-						pixel = index.y*width + index.x;
-						if(tmp_data[pixel] > 0)
-						{
-							tmp_data[pixel] = 0;
-							label_data[pixel] = label;
-							addNeigbours(&indices, neighbours, index,  image.getRank(), *image.getDimensions());
-						}
-					}
-					label++;
-				}
-
+				label_data[pixel] = 0;
+				continue;
+			}
+			if(initialize)
+			{
+				label_data[pixel] = 1;
+				parent[pixel] = pixel;
+			}
+			int i = pixel % width,
+				j = (pixel / width) % height,
+				k = pixel / (width*height);
+			for(const glm::ivec3 &n : preceding)
+			{
+				int x = i + n.x,
+					y = j + n.y,
+					z = k + n.z,
+					plane = depth > 1 ? z : y;
+				if(x < 0 || x >= width || y < 0 || y >= height || z < 0 || z >= depth || plane < first_plane || plane >= last_plane)
+					continue;
+				int other = x + y*width + z*width*height;
+				if(label_data[other])
+					unite(parent, pixel, other);
 			}
 		}
+	};
+	parallelFor(0, num_slabs, [&](int s)
+	{
+		scan(slab_begin[s], slab_begin[s+1], slab_begin[s], slab_begin[s+1], true);
+	}, num_slabs);
+	// merge equivalences across slab boundaries, only the first plane of each slab has links into the previous one
+	for(int s=1; s<num_slabs; ++s)
+	{
+		scan(0, num_planes, slab_begin[s], slab_begin[s]+1, false);
 	}
-	return label_image;
 
+	// second pass: number the roots in scan order, every other pixel takes the label of its root
+	int num_components = 0;
+	for(int pixel=0; pixel<num_pixels; ++pixel)
+	{
+		if(label_data[pixel] && parent[pixel] == pixel)
+			label_data[pixel] = label + num_components++;
+	}
+	parallelFor(0, num_slabs, [&](int s)
+	{
+		for(int pixel=slab_begin[s]*plane_size; pixel<slab_begin[s+1]*plane_size; ++pixel)
+		{
+			if(label_data[pixel] && parent[pixel] != pixel)
+			{
+				int root = parent[pixel];
+				while(parent[root] != root)
+					root = parent[root];
+				label_data[pixel] = label_data[root];
+			}
+		}
+	}, num_slabs);
+	label += num_components;
+	return label_image;
 }
 
 } /* end namespace elib */
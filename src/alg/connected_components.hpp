@@ -8,7 +8,6 @@
 #ifndef CONNECTEDCOMPONENTS_HPP_
 #define CONNECTEDCOMPONENTS_HPP_
 
-#include <queue>
 #include <vector>
 
 #include "glm/glm.hpp"
@@ -16,18 +15,26 @@
 
 namespace elib{
 
+/*
+ * Labels the connected components of the foreground (pixels > 0) of 2D and 3D images. Components are
+ * numbered in scan order of their first pixel, starting at the label offset, which is advanced past the
+ * labels used. Two-pass union-find: slabs of planes (z-slices, rows in 2D) are labeled concurrently,
+ * equivalences across slab boundaries are merged afterwards.
+ */
 class ConnectedComponents
 {
 	public:
 		ConnectedComponents();
 		virtual ~ConnectedComponents();
 
-		const static short SMALL_CONNECTIVITY = 0;
-		const static short LARGE_CONNECTIVITY = 1;
+		const static short SMALL_CONNECTIVITY = 0;	/* 4 (2D), 6 (3D) neighbours */
+		const static short LARGE_CONNECTIVITY = 1;	/* 8 (2D), 14 (3D, faces and corners) neighbours */
+		const static short EDGE_CONNECTIVITY = 2;	/* 8 (2D), 18 (3D, faces and edges) neighbours */
+		const static short FULL_CONNECTIVITY = 3;	/* 8 (2D), 26 (3D) neighbours */
 		static std::vector<glm::ivec3> SMALL_2D, LARGE_2D;
-		static std::vector<glm::ivec3> SMALL_3D, LARGE_3D;
+		static std::vector<glm::ivec3> SMALL_3D, LARGE_3D, EDGE_3D, FULL_3D;
 
-		Image<int> getComponents(Image<int> image);
+		Image<int> getComponents(const Image<int> &image);
 		short getConnectivity() const
 		{
 			return connectivity;
@@ -44,32 +51,18 @@ class ConnectedComponents
 		{
 			this->label = label;
 		}
-
-		template<typename Point>
-		inline static void addNeigbours(std::queue<Point> *indices, std::vector<Point> *neighbours, Point index, int rank, const std::vector<int> &dimensions)
+		/* 0 uses all hardware threads */
+		void setNumberOfThreads(int num_threads = 0)
 		{
-			typename std::vector<Point>::iterator it;
-			Point neighbour;
-			bool push;
-
-			for(it = neighbours->begin(); it!=neighbours->end(); ++it)
-			{
-				neighbour = index+*it;
-				push = true;
-				for(int i=0; i<rank; ++i)
-				{
-					if(neighbour[i] < 0 || neighbour[i] >= dimensions[i])
-						push = false;
-				}
-				if(push)
-				{
-					indices->push(neighbour);
-				}
-			}
+			this->num_threads = num_threads;
 		}
+
 	private:
+		const std::vector<glm::ivec3>& getNeighbours(int rank) const;
+
 		int label = 1;
 		short connectivity = LARGE_CONNECTIVITY;
+		int num_threads = 0;
 };
 
 } /* namespace elib */
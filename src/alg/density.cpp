@@ -7,22 +7,392 @@
 
 #include "density.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <iostream>
+#include <limits>
+#include <memory>
 
 #include "glm/gtx/norm.hpp"
 #include "templates/tensor.hpp"
 #include "utilities/math_functions.hpp"
+#include "utilities/fft.hpp"
+#include "utilities/great_circle.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/profile.hpp"
 
 namespace elib
 {
 
+namespace
+{
+
+/*
+ * Uniform grid of buckets over the bounding box of a point set, with cells about the size of the search
+ * radius, so a query only visits the points of the cells overlapping its cubic neighbourhood.
+ */
+class PointGrid
+{
+	public:
+		template <typename Vector>
+		PointGrid(const std::vector<Vector> &points, double radius) : radius(std::max(0., radius))
+		{
+			double upper[3];
+			for(int d=0; d<3; ++d)
+			{
+				origin[d] = points.empty() ? 0 : double(points[0][d]);
+				upper[d] = origin[d];
+			}
+			for(const Vector &p : points)
+			{
+				for(int d=0; d<3; ++d)
+				{
+					origin[d] = std::min(origin[d], double(p[d]));
+					upper[d] = std::max(upper[d], double(p[d]));
+				}
+			}
+			int max_cells = std::max(1, std::min(MAX_CELLS_PER_AXIS, int(2*std::cbrt(double(points.size())))));
+			for(int d=0; d<3; ++d)
+			{
+				double extent = upper[d]-origin[d];
+				cells[d] = extent > 0 ? std::max(1, std::min(max_cells, int(extent/std::max(this->radius, 1e-12)))) : 1;
+				cell_size[d] = extent > 0 ? extent/cells[d] : 1;
+			}
+
+			// counting sort of the point indices by cell
+			std::vector<int> point_cells(points.size());
+			cell_begin.assign(cells[0]*cells[1]*cells[2]+1, 0);
+			for(std::size_t k=0; k<points.size(); ++k)
+			{
+				point_cells[k] = cell(0, points[k].x) + (cell(1, points[k].y) + cell(2, points[k].z)*cells[1])*cells[0];
+				++cell_begin[point_cells[k]+1];
+			}
+			for(std::size_t c=1; c<cell_begin.size(); ++c)
+			{
+				cell_begin[c] += cell_begin[c-1];
+			}
+			indices.resize(points.size());
+			std::vector<int> position(cell_begin.begin(), cell_begin.end()-1);
+			for(std::size_t k=0; k<points.size(); ++k)
+			{
+				indices[position[point_cells[k]]++] = int(k);
+			}
+		}
+
+		/* calls function(k) for every point k that may lie within radius of p */
+		template <typename Function>
+		void query(const glm::dvec3 &p, Function function) const
+		{
+			queryRanges(p, radius, [&](int begin, int end)
+			{
+				for(int k=begin; k<end; ++k)
+				{
+					function(indices[k]);
+				}
+			});
+		}
+		/*
+		 * calls function(begin, end) for the ranges of positions in getOrder() holding the points that may
+		 * lie within radius of p
+		 */
+		template <typename Function>
+		void queryRanges(const glm::dvec3 &p, double radius, Function function) const
+		{
+			// widened a little, so rounding can't drop a cell, the caller tests the exact distance
+			double r = radius*(1+1e-6) + 1e-12;
+			int x0 = cell(0, p.x-r), x1 = cell(0, p.x+r),
+				y0 = cell(1, p.y-r), y1 = cell(1, p.y+r),
+				z0 = cell(2, p.z-r), z1 = cell(2, p.z+r);
+			for(int cz=z0; cz<=z1; ++cz)
+			{
+				for(int cy=y0; cy<=y1; ++cy)
+				{
+					int row = (cy + cz*cells[1])*cells[0];
+					function(cell_begin[row+x0], cell_begin[row+x1+1]);
+				}
+			}
+		}
+		/* point indices sorted by cell */
+		const std::vector<int>* getOrder() const
+		{
+			return &indices;
+		}
+
+	private:
+		const static int MAX_CELLS_PER_AXIS = 1024;
+
+		double radius, origin[3], cell_size[3];
+		int cells[3];
+		std::vector<int> cell_begin, indices;
+
+		inline int cell(int d, double x) const
+		{
+			return std::max(0, std::min(cells[d]-1, int(std::floor((x-origin[d])/cell_size[d]))));
+		}
+};
+
+/*
+ * Points on a sphere given as (longitude, latitude + Pi/2, radius), as returned by toPolar,
+ * bucketed by their unit vectors. The unit vectors are stored cell by cell in single precision, so the
+ * candidates of a query are contiguous and tested in batches by accumulateWithinChords.
+ */
+class SphericalIndex
+{
+	public:
+		SphericalIndex(const std::vector<glm::vec3> &points, double band_width, double radius)
+		{
+			std::vector<glm::dvec3> vectors;
+			vectors.reserve(points.size());
+			for(const glm::vec3 &p : points)
+			{
+				vectors.push_back(unitVector(p));
+			}
+			grid = std::unique_ptr<PointGrid>(new PointGrid(vectors, chord(band_width, radius)));
+			const std::vector<int> &order = *grid->getOrder();
+			x.resize(order.size());
+			y.resize(order.size());
+			z.resize(order.size());
+			for(std::size_t k=0; k<order.size(); ++k)
+			{
+				x[k] = float(vectors[order[k]].x);
+				y[k] = float(vectors[order[k]].y);
+				z[k] = float(vectors[order[k]].z);
+			}
+		}
+
+		/* rows of a row-major matrix of values of the points, one row per point, in the order of the index */
+		std::vector<double> sort(const double *values, int num_values = 1) const
+		{
+			const std::vector<int> &order = *grid->getOrder();
+			std::vector<double> sorted(order.size()*num_values);
+			for(std::size_t k=0; k<order.size(); ++k)
+			{
+				std::copy(values + std::size_t(order[k])*num_values, values + std::size_t(order[k]+1)*num_values, sorted.begin() + k*num_values);
+			}
+			return sorted;
+		}
+		/* number of points within band_width of p */
+		int count(const glm::vec3 &p, double band_width) const
+		{
+			int count = 0;
+			accumulate(p, &band_width, 1, nullptr, 0, &count, nullptr);
+			return count;
+		}
+		/*
+		 * number of points within each of the band widths of p, summing the num_weights weights of these points,
+		 * sorted rows of a matrix, into weight_sums as accumulateWithinChords
+		 */
+		void accumulate(const glm::vec3 &p, const double *band_widths, int num_band_widths, const double *sorted_weights, int num_weights,
+				int *counts, double *weight_sums) const
+		{
+			glm::dvec3 u = unitVector(p);
+			float q[3] = {float(u.x), float(u.y), float(u.z)};
+			float max_squared_chords[num_band_widths];
+			double query_radius = 0;
+			for(int b=0; b<num_band_widths; ++b)
+			{
+				max_squared_chords[b] = squaredChord(band_widths[b], p.z);
+				query_radius = std::max(query_radius, chord(band_widths[b], p.z));
+			}
+			grid->queryRanges(u, query_radius, [&](int begin, int end)
+			{
+				accumulateWithinChords(x.data()+begin, y.data()+begin, z.data()+begin, sorted_weights + std::size_t(begin)*num_weights, num_weights,
+						end-begin, q, max_squared_chords, num_band_widths, counts, weight_sums);
+			});
+		}
+
+		/* calls function(k) for every point k within band_width of p, with the single precision test of accumulate */
+		template <typename Function>
+		void forEachWithin(const glm::vec3 &p, double band_width, Function function) const
+		{
+			glm::dvec3 u = unitVector(p);
+			float q[3] = {float(u.x), float(u.y), float(u.z)},
+				max_squared_chord = squaredChord(band_width, p.z);
+			const std::vector<int> &order = *grid->getOrder();
+			grid->queryRanges(u, chord(band_width, p.z), [&](int begin, int end)
+			{
+				for(int k=begin; k<end; ++k)
+				{
+					float dx = x[k]-q[0],
+						dy = y[k]-q[1],
+						dz = z[k]-q[2],
+						d2 = dx*dx + dy*dy + dz*dz;
+					if(d2 <= max_squared_chord)
+						function(order[k]);
+				}
+			});
+		}
+
+	private:
+		std::unique_ptr<PointGrid> grid;
+		std::vector<float> x, y, z;
+
+		static glm::dvec3 unitVector(const glm::vec3 &p)
+		{
+			double latitude = double(p.y)-M_PI_2;
+			return glm::dvec3(cos(latitude)*cos(double(p.x)), cos(latitude)*sin(double(p.x)), sin(latitude));
+		}
+		/* chord of the neighbourhood, widened for the single precision coordinates */
+		static double chord(double band_width, double radius)
+		{
+			float squared_chord = squaredChord(band_width, radius);
+			return squared_chord > 0 ? std::sqrt(double(squared_chord))*(1+1e-4) + 1e-5 : 0;
+		}
+};
+
+/* the CARTESIAN neighbourhood criterion, points closer than band_width^2 */
+inline bool withinCartesianBandWidth(const glm::vec3 &p1, const glm::vec3 &p2, double band_width)
+{
+	return std::sqrt(glm::l2Norm(p1-p2)) <= band_width;
+}
+
+/* weight of a point at distance u in units of the kernel scale, 1 at the centre */
+inline double kernelWeight(int kernel, double u)
+{
+	if(kernel == static_cast<int>(Density::kernel_type::GAUSSIAN))
+		return std::exp(-0.5*u*u);
+	return u <= 1 ? 1-u*u : 0;
+}
+
+/* pixel range of the binning grid along one axis and the length of the transform */
+struct ConvolutionAxis
+{
+	int lower, size, reach, length;
+
+	ConvolutionAxis(double min, double max, int pixels, double reach_pixels)
+	{
+		double limit = double(std::numeric_limits<int>::max()/4);
+		reach = int(std::min(std::ceil(reach_pixels), limit));
+		// points farther than the kernel reach from the image do not contribute
+		lower = int(std::min(0., std::max(-double(reach), std::floor(min))));
+		long long upper = (long long)std::max(double(pixels-1), std::min(double(pixels-1)+reach, std::ceil(max)));
+		// offsets beyond the farthest pair of grid cell and pixel never contribute
+		reach = int(std::min((long long)reach, std::max(pixels-1-(long long)lower, upper)));
+		// no wrap around of the circular convolution for pixels of the image, lengths beyond int are invalid
+		long long extent = upper-lower+1,
+			padded = extent+reach;
+		size = extent <= std::numeric_limits<int>::max() ? int(extent) : -1;
+		length = padded <= std::numeric_limits<int>::max() ? nextPowerOfTwo(int(padded)) : -1;
+	}
+
+	/* false if the transform would be too long */
+	bool isValid() const
+	{
+		return size > 0 && length > 0;
+	}
+};
+
+/*
+ * CARTESIAN density with a smooth kernel, whose scale is the radius of the disk in coordinates normalized by
+ * the original dimensions. Points are binned linearly onto the pixel lattice, which is extended by the kernel
+ * reach where points lie, and convolved with the kernel by FFT, O(N + P log P). Binning is accurate once the
+ * kernel spans several pixels, narrower kernels, and lattices too large to transform, are summed exactly over
+ * the points bucketed near a pixel.
+ */
+void smoothCartesianDensity(const std::vector<glm::vec3> &points, const int *dims, double scale, int kernel,
+		double *density, int num_threads)
+{
+	const double MIN_CONVOLUTION_REACH = 8;	/* pixels */
+	const long long MAX_CONVOLUTION_CELLS = 1LL << 28;	/* 4 GiB per complex grid */
+	double reach = kernel == static_cast<int>(Density::kernel_type::GAUSSIAN) ? 4*scale : scale;
+	auto weight = [&](double distance)
+	{
+		if(distance > reach)
+			return 0.;
+		return kernelWeight(kernel, scale > 0 ? distance/scale : 0);
+	};
+
+	std::fill(density, density + std::size_t(dims[0])*dims[1], 0.);
+	if(points.empty())
+		return;
+	double min[2] = {double(points[0].x)*dims[0], double(points[0].y)*dims[1]},
+		max[2] = {min[0], min[1]};
+	for(const glm::vec3 &p : points)
+	{
+		double q[2] = {double(p.x)*dims[0], double(p.y)*dims[1]};
+		for(int d=0; d<2; ++d)
+		{
+			min[d] = std::min(min[d], q[d]);
+			max[d] = std::max(max[d], q[d]);
+		}
+	}
+	ConvolutionAxis x(min[0], max[0], dims[0], reach*dims[0]),
+		y(min[1], max[1], dims[1], reach*dims[1]);
+
+	// too long transforms, beyond int or the cell limit, fall back to the exact sum as well
+	if(reach*std::min(dims[0], dims[1]) < MIN_CONVOLUTION_REACH || !x.isValid() || !y.isValid()
+			|| (long long)x.length*y.length > MAX_CONVOLUTION_CELLS)
+	{
+		PointGrid grid(points, reach);
+		parallelFor(0, dims[1], [&](int j)
+		{
+			for(int i=0; i<dims[0]; ++i)
+			{
+				glm::vec3 q = glm::vec3(double(i)/dims[0],double(j)/dims[1],0);
+				double sum = 0;
+				grid.query(glm::dvec3(q.x, q.y, q.z), [&](int k)
+				{
+					sum += weight(glm::l2Norm(q-points[k]));
+				});
+				density[i + j*dims[0]] = sum;
+			}
+		}, num_threads);
+		return;
+	}
+
+	std::size_t length = std::size_t(x.length)*y.length;
+	std::vector<std::complex<double>> grid(length), kernel_grid(length);
+	for(const glm::vec3 &p : points)
+	{
+		double gx = double(p.x)*dims[0] - x.lower,
+			gy = double(p.y)*dims[1] - y.lower,
+			i0 = std::floor(gx),
+			j0 = std::floor(gy),
+			fx = gx-i0,
+			fy = gy-j0;
+		for(int dj=0; dj<2; ++dj)
+		{
+			for(int di=0; di<2; ++di)
+			{
+				double i = i0+di,
+					j = j0+dj;
+				if(i >= 0 && i < x.size && j >= 0 && j < y.size)
+					grid[std::size_t(i) + std::size_t(j)*x.length] += (di ? fx : 1-fx)*(dj ? fy : 1-fy);
+			}
+		}
+	}
+	parallelFor(-y.reach, y.reach+1, [&](int dy)
+	{
+		std::complex<double> *row = kernel_grid.data() + std::size_t((dy + y.length) % y.length)*x.length;
+		for(int dx=-x.reach; dx<=x.reach; ++dx)
+		{
+			row[(dx + x.length) % x.length] = weight(std::sqrt(std::pow(double(dx)/dims[0], 2) + std::pow(double(dy)/dims[1], 2)));
+		}
+	}, num_threads);
+
+	fft2D(grid.data(), x.length, y.length, false, num_threads);
+	fft2D(kernel_grid.data(), x.length, y.length, false, num_threads);
+	for(std::size_t k=0; k<length; ++k)
+	{
+		grid[k] *= kernel_grid[k];
+	}
+	fft2D(grid.data(), x.length, y.length, true, num_threads);
+	parallelFor(0, dims[1], [&](int j)
+	{
+		for(int i=0; i<dims[0]; ++i)
+		{
+			// clamp the round-off of the transforms
+			density[i + std::size_t(j)*dims[0]] = std::max(0., grid[std::size_t(i - x.lower) + std::size_t(j - y.lower)*x.length].real()/length);
+		}
+	}, num_threads);
+}
+
+} /* end anonymous namespace */
+
 Tensor<double>* Density::calculateDensity(elib::Tensor<double> &points, elib::Parameters &params)
 {
-	std::vector<glm::ivec2> coordinates;
-	std::vector<glm::vec3> polar_coordinates, polar_points;
-	glm::vec3 p;
-	glm::ivec2 c;
+	std::vector<glm::vec3> polar_points;
 
 	int rank, type;
 	const Tensor<int> *dimensions, *original_dimensions;
@@ -41,6 +411,13 @@ Tensor<double>* Density::calculateDensity(elib::Tensor<double> &points, elib::Pa
 	{
 		return nullptr;
 	}
+	int num_threads = params.getIntegerParameter("Threads"),
+		kernel = params.getIntegerParameter("Kernel");
+	if(kernel < static_cast<int>(kernel_type::DISK) || kernel > static_cast<int>(kernel_type::EPANECHNIKOV) ||
+			(kernel != static_cast<int>(kernel_type::DISK) && type != static_cast<int>(density_type::CARTESIAN)))
+	{
+		return nullptr;
+	}
 	Tensor<double> *density = new Tensor<double>(rank, dimensions->getData());
 	double *tensor_data = density->getData();
 	int *dims = const_cast<Tensor<int>* >(dimensions)->getData();
@@ -53,76 +430,63 @@ Tensor<double>* Density::calculateDensity(elib::Tensor<double> &points, elib::Pa
 		switch(type)
 		{
 			case static_cast<int>(density_type::BONNE):
+			case static_cast<int>(density_type::MERCATOR):
+			{
+				ScopedTimer index_timer("density index");
+				polar_points.reserve(points.getFlattenedLength()/2);
 				for(int k=0; k<points.getFlattenedLength(); k+=2)
 				{
 					polar_points.push_back(toPolar(glm::vec2(point_data[k],point_data[k+1]), radius, lateral_projection_range, original_dims));
 				}
-				for(int j = 0; j < dims[1]; ++j)
+				SphericalIndex index(polar_points, band_width, radius);
+				index_timer.stop();
+				std::shared_ptr<const ProjectionCache::Grid> grid = getProjectionGrid(type, dims, radius, lateral_projection_range,
+						standard_parallel, central_meridian, num_threads);
+				ScopedTimer counting_timer("density counting");
+				parallelFor(0, dims[1], [&](int j)
 				{
 					for (int i = 0; i < dims[0]; ++i)
 					{
-						coordinates.push_back(glm::ivec2(i, j));
-						p = glm::vec3((double(i)/double(dims[0]))*M_PI*2-M_PI, (double(j)/double(dims[1]))*M_PI*2-M_PI,radius);
-						polar_coordinates.push_back(inverseBonne(p, standard_parallel, central_meridian));
-					}
-				}
-				for(unsigned int i=0; i<polar_coordinates.size(); ++i)
-				{
-					p = polar_coordinates[i];
-					c = coordinates[i];
-					if(fabs(p.x) <= M_PI && fabs(p.y) <= M_PI_2)
-					{
-						for(unsigned int j=0; j<polar_points.size(); ++j)
-						{
-							if(greatCircleDistance(p+glm::vec3(M_PI, M_PI_2, 0), polar_points[j]) <= band_width)
-								tensor_data[c.x + c.y*dims[0]] += 1;
-						}
-					}
-					else
-					{
-						tensor_data[c.x + c.y*dims[0]] = 0;
+						int pixel = i + j*dims[0];
+						tensor_data[pixel] = grid->inside[pixel] ? index.count(grid->coordinates[pixel], band_width) : 0;
 					}
-				}
+				}, num_threads);
 				break;
+			}
 			case static_cast<int>(density_type::CARTESIAN):
+			{
+				polar_points.reserve(points.getFlattenedLength()/2);
 				for(int k=0; k<points.getFlattenedLength(); k+=2)
 				{
 					polar_points.push_back(glm::vec3(point_data[k]/original_dims[0],point_data[k+1]/original_dims[1],0));
 				}
-				for(int j=0; j<dims[1]; ++j)
-				{
-					for(int i=0; i<dims[0]; ++i)
-					{
-						p = glm::vec3(i/dims[0],j/dims[1],0);
-						for(auto k=polar_points.begin(); k!=polar_points.end(); ++k)
-							if(std::sqrt(glm::l2Norm(p-*k)) <= band_width)
-								tensor_data[i + j*dims[0]] += 1;
-					}
-				}
-				break;
-			case static_cast<int>(density_type::MERCATOR):
-				for(int k=0; k<points.getFlattenedLength(); k+=2)
+				if(kernel != static_cast<int>(kernel_type::DISK))
 				{
-					polar_points.push_back(toPolar(glm::vec2(point_data[k],point_data[k+1]), radius, lateral_projection_range, original_dims));
+					ScopedTimer smoothing_timer("density smoothing");
+					smoothCartesianDensity(polar_points, dims, band_width*band_width, kernel, tensor_data, num_threads);
+					break;
 				}
-				for(int j=0; j<dims[1]; ++j)
+				// sqrt of the distance is compared against band_width
+				ScopedTimer index_timer("density index");
+				PointGrid grid(polar_points, band_width*band_width);
+				index_timer.stop();
+				ScopedTimer counting_timer("density counting");
+				parallelFor(0, dims[1], [&](int j)
 				{
 					for(int i=0; i<dims[0]; ++i)
 					{
-						coordinates.push_back(glm::ivec2(i,j));
-						polar_coordinates.push_back(toPolar(glm::vec2(i,j), radius, lateral_projection_range, dims));
-					}
-				}
-				for(unsigned int i=0; i<polar_coordinates.size(); ++i)
-				{
-					for(unsigned int j=0; j<polar_points.size(); ++j)
-					{
-						c = coordinates[i];
-						if(greatCircleDistance(polar_coordinates[i],polar_points[j]) <= band_width)
-							tensor_data[c.x + c.y*dims[0]] += 1;
+						glm::vec3 q = glm::vec3(double(i)/dims[0],double(j)/dims[1],0);
+						int count = 0;
+						grid.query(glm::dvec3(q.x, q.y, q.z), [&](int k)
+						{
+							if(withinCartesianBandWidth(q, polar_points[k], band_width))
+								++count;
+						});
+						tensor_data[i + j*dims[0]] = count;
 					}
-				}
+				}, num_threads);
 				break;
+			}
 			default:
 				density=nullptr;
 				break;
@@ -133,21 +497,42 @@ Tensor<double>* Density::calculateDensity(elib::Tensor<double> &points, elib::Pa
 
 Tensor<double>* Density::calculateFeatureMap(elib::Tensor<double> &points, elib::Tensor<double> &features, elib::Parameters &params)
 {
-	std::vector<glm::ivec2> coordinates;
-	std::vector<glm::vec3> polar_coordinates, polar_points;
-	glm::vec3 p;
-	glm::ivec2 c;
+	double band_width;
+	const Tensor<int> *dimensions;
+	if(
+		elib::isnan(band_width = params.getDoubleParameter("BandWidth")) ||
+		(dimensions = params.getIntegerTensorParameter("Dimensions")) == nullptr
+	)
+	{
+		return nullptr;
+	}
+	std::vector<int> one(1, 1);
+	Tensor<double> band_widths(1, one);
+	band_widths.getData()[0] = band_width;
+	std::unique_ptr<Tensor<double>> maps(calculateFeatureMaps(points, features, band_widths, params));
+	if(maps == nullptr)
+	{
+		return nullptr;
+	}
+	// the first map holds the first feature of the only band width
+	Tensor<double> *feature_tensor = new Tensor<double>(dimensions->getFlattenedLength(), dimensions->getData());
+	std::copy(maps->getData(), maps->getData() + feature_tensor->getFlattenedLength(), feature_tensor->getData());
+	return feature_tensor;
+}
+
+Tensor<double>* Density::calculateFeatureMaps(elib::Tensor<double> &points, elib::Tensor<double> &features, elib::Tensor<double> &band_widths, elib::Parameters &params)
+{
+	std::vector<glm::vec3> polar_points;
 
 	int rank, type;
 	const Tensor<int> *dimensions, *original_dimensions;
-	double radius, lateral_projection_range, band_width, central_meridian, standard_parallel;
+	double radius, lateral_projection_range, central_meridian, standard_parallel;
 	if(
 		elib::isnan(rank = params.getIntegerParameter("Rank")) ||
 		(dimensions = params.getIntegerTensorParameter("Dimensions")) == nullptr ||
 		(original_dimensions = params.getIntegerTensorParameter("OriginalDimensions")) == nullptr ||
 		elib::isnan(radius = params.getDoubleParameter("Radius")) ||
 		elib::isnan(lateral_projection_range = params.getDoubleParameter("LateralProjectionRange")) ||
-		elib::isnan(band_width = params.getDoubleParameter("BandWidth")) ||
 		elib::isnan(type = params.getIntegerParameter("Type")) ||
 		elib::isnan(central_meridian = params.getDoubleParameter("CentralMeridian")) ||
 		elib::isnan(standard_parallel = params.getDoubleParameter("StandardParallel"))
@@ -155,138 +540,349 @@ Tensor<double>* Density::calculateFeatureMap(elib::Tensor<double> &points, elib:
 	{
 		return nullptr;
 	}
-	Tensor<double> density = Tensor<double>(rank, dimensions->getData());
-	Tensor<double> *feature_tensor = new Tensor<double>(rank, dimensions->getData());
-	double *tensor_data = density.getData();
-	double *feature_data = feature_tensor->getData();
+	int num_threads = params.getIntegerParameter("Threads"),
+		num_points = points.getFlattenedLength()/2,
+		num_features = features.getRank() > 1 ? (*features.getDimensions())[1] : 1,
+		num_band_widths = band_widths.getFlattenedLength();
+	if(rank != 2 || num_band_widths == 0 || features.getFlattenedLength() != num_points*num_features)
+	{
+		return nullptr;
+	}
 	int *dims = const_cast<Tensor<int>* >(dimensions)->getData();
 	int *original_dims = const_cast<Tensor<int>* >(original_dimensions)->getData();
+	int num_pixels = dims[0]*dims[1],
+		num_maps = num_features+1;
+	const double *bws = band_widths.getData(),
+		*feature_data = features.getData();
+	double max_band_width = *std::max_element(bws, bws + num_band_widths);
 
+	std::vector<int> map_dimensions = {num_band_widths, num_maps, dims[0], dims[1]};
+	Tensor<double> *maps = new Tensor<double>(4, map_dimensions);
+	double *map_data = maps->getData();
+	// averaged features and the count of a pixel for every band width
+	auto store = [&](int pixel, const int *counts, const double *sums)
+	{
+		for(int b=0; b<num_band_widths; ++b)
+		{
+			double *map = map_data + std::size_t(b)*num_maps*num_pixels + pixel;
+			for(int f=0; f<num_features; ++f)
+			{
+				map[std::size_t(f)*num_pixels] = sums[b*num_features+f]/fmax(1, counts[b]); //prevent division by 0
+			}
+			map[std::size_t(num_features)*num_pixels] = counts[b];
+		}
+	};
 
-	if(rank == 2)
+	double* point_data = points.getData();
+	switch(type)
 	{
-		double* point_data = points.getData();
-		switch(type)
+		case static_cast<int>(density_type::BONNE):
+		case static_cast<int>(density_type::MERCATOR):
 		{
-			case static_cast<int>(density_type::BONNE):
-				for(int k=0; k<points.getFlattenedLength(); k+=2)
+			polar_points.reserve(num_points);
+			for(int k=0; k<points.getFlattenedLength(); k+=2)
+			{
+				polar_points.push_back(toPolar(glm::vec2(point_data[k],point_data[k+1]), radius, lateral_projection_range, original_dims));
+			}
+			SphericalIndex index(polar_points, max_band_width, radius);
+			std::vector<double> sorted_features = index.sort(feature_data, num_features);
+			std::shared_ptr<const ProjectionCache::Grid> grid = getProjectionGrid(type, dims, radius, lateral_projection_range,
+					standard_parallel, central_meridian, num_threads);
+			parallelFor(0, dims[1], [&](int j)
+			{
+				std::vector<int> counts(num_band_widths);
+				std::vector<double> sums(num_band_widths*num_features);
+				for(int i=0; i<dims[0]; ++i)
 				{
-					polar_points.push_back(toPolar(glm::vec2(point_data[k],point_data[k+1]), radius, lateral_projection_range, original_dims));
+					int pixel = i + j*dims[0];
+					std::fill(counts.begin(), counts.end(), 0);
+					std::fill(sums.begin(), sums.end(), 0.);
+					if(grid->inside[pixel])
+						index.accumulate(grid->coordinates[pixel], bws, num_band_widths, sorted_features.data(), num_features, counts.data(), sums.data());
+					store(pixel, counts.data(), sums.data());
 				}
-				for(int j = 0; j < dims[1]; ++j)
-				{
-					for (int i = 0; i < dims[0]; ++i)
-					{
-						coordinates.push_back(glm::ivec2(i, j));
-						p = glm::vec3((double(i)/double(dims[0]))*M_PI*2-M_PI, (double(j)/double(dims[1]))*M_PI*2-M_PI,radius);
-						polar_coordinates.push_back(inverseBonne(p, standard_parallel, central_meridian));
-					}
-				}
-				for(unsigned int i=0; i<polar_coordinates.size(); ++i)
+			}, num_threads);
+			break;
+		}
+		case static_cast<int>(density_type::CARTESIAN):
+		{
+			polar_points.reserve(num_points);
+			for(int k=0; k<points.getFlattenedLength(); k+=2)
+			{
+				polar_points.push_back(glm::vec3(point_data[k]/original_dims[0],point_data[k+1]/original_dims[1],0));
+			}
+			PointGrid grid(polar_points, max_band_width*max_band_width);
+			parallelFor(0, dims[1], [&](int j)
+			{
+				std::vector<int> counts(num_band_widths);
+				std::vector<double> sums(num_band_widths*num_features);
+				for(int i=0; i<dims[0]; ++i)
 				{
-					p = polar_coordinates[i];
-					c = coordinates[i];
-					if(fabs(p.x) <= M_PI && fabs(p.y) <= M_PI_2)
+					std::fill(counts.begin(), counts.end(), 0);
+					std::fill(sums.begin(), sums.end(), 0.);
+					glm::vec3 q = glm::vec3(double(i)/dims[0],double(j)/dims[1],0);
+					grid.query(glm::dvec3(q.x, q.y, q.z), [&](int k)
 					{
-						for(unsigned int j=0; j<polar_points.size(); ++j)
+						for(int b=0; b<num_band_widths; ++b)
 						{
-							if(greatCircleDistance(p+glm::vec3(M_PI, M_PI_2, 0), polar_points[j]) <= band_width)
+							if(withinCartesianBandWidth(q, polar_points[k], bws[b]))
 							{
-								tensor_data[c.x + c.y*dims[0]] += 1;
-								feature_data[c.x + c.y*dims[0]] += features.get(j);
+								++counts[b];
+								for(int f=0; f<num_features; ++f)
+								{
+									sums[b*num_features+f] += feature_data[std::size_t(k)*num_features+f];
+								}
 							}
 						}
-					}
-					else
-					{
-						tensor_data[c.x + c.y*dims[0]] = 0;
-					}
-				}
-				break;
-			case static_cast<int>(density_type::CARTESIAN):
-				for(int k=0; k<points.getFlattenedLength(); k+=2)
-				{
-					polar_points.push_back(glm::vec3(point_data[k]/original_dims[0],point_data[k+1]/original_dims[1],0));
-				}
-				for(int j=0; j<dims[1]; ++j)
-				{
-					for(int i=0; i<dims[0]; ++i)
-					{
-						p = glm::vec3(i/dims[0],j/dims[1],0);
-						for(auto k=0; k < polar_points.size(); ++k)
-							if(std::sqrt(glm::l2Norm(p-polar_points[k])) <= band_width)
-							{
-								tensor_data[i + j*dims[0]] += 1;
-								feature_data[i + j*dims[0]] += features.get(j);
-							}
-					}
-				}
-				break;
-			case static_cast<int>(density_type::MERCATOR):
-				for(int k=0; k<points.getFlattenedLength(); k+=2)
-				{
-					polar_points.push_back(toPolar(glm::vec2(point_data[k],point_data[k+1]), radius, lateral_projection_range, original_dims));
+					});
+					store(i + j*dims[0], counts.data(), sums.data());
 				}
-				for(int j=0; j<dims[1]; ++j)
+			}, num_threads);
+			break;
+		}
+		default:
+			delete maps;
+			maps = nullptr;
+			break;
+	}
+	return maps;
+}
+
+std::shared_ptr<const ProjectionCache::Grid> Density::getProjectionGrid(int type, const int *dims, double radius,
+		double lateral_projection_range, double standard_parallel, double central_meridian, int num_threads)
+{
+	ProjectionCache::Key key = {type, dims[0], dims[1], radius, lateral_projection_range, standard_parallel, central_meridian};
+	// the other parameters do not enter the respective projection
+	if(type == static_cast<int>(density_type::BONNE))
+		key.lateral_projection_range = 0;
+	else
+		key.standard_parallel = key.central_meridian = 0;
+	return ProjectionCache::getInstance().get(key, [&](ProjectionCache::Grid &grid)
+	{
+		ScopedTimer timer("density projection grid");
+		grid.coordinates.resize(std::size_t(dims[0])*dims[1]);
+		grid.inside.resize(std::size_t(dims[0])*dims[1], 1);
+		parallelFor(0, dims[1], [&](int j)
+		{
+			for(int i=0; i<dims[0]; ++i)
+			{
+				std::size_t pixel = i + std::size_t(j)*dims[0];
+				if(type == static_cast<int>(density_type::BONNE))
 				{
-					for(int i=0; i<dims[0]; ++i)
-					{
-						coordinates.push_back(glm::ivec2(i,j));
-						polar_coordinates.push_back(toPolar(glm::vec2(i,j), radius, lateral_projection_range, dims));
-					}
+					glm::vec3 q = inverseBonne(glm::vec3((double(i)/double(dims[0]))*M_PI*2-M_PI, (double(j)/double(dims[1]))*M_PI*2-M_PI,radius), standard_parallel, central_meridian);
+					grid.inside[pixel] = fabs(q.x) <= M_PI && fabs(q.y) <= M_PI_2;
+					grid.coordinates[pixel] = q+glm::vec3(M_PI, M_PI_2, 0);
 				}
-				for(unsigned int i=0; i<polar_coordinates.size(); ++i)
+				else
 				{
-					for(unsigned int j=0; j<polar_points.size(); ++j)
-					{
-						c = coordinates[i];
-						if(greatCircleDistance(polar_coordinates[i],polar_points[j]) <= band_width)
-						{
-							tensor_data[c.x + c.y*dims[0]] += 1;
-							feature_data[c.x + c.y*dims[0]] += features.get(j);
-						}
-					}
+					grid.coordinates[pixel] = toPolar(glm::vec2(i,j), radius, lateral_projection_range, dims);
 				}
-				break;
-			default:
-				feature_tensor=nullptr;
-				break;
-		}
+			}
+		}, num_threads);
+	});
+}
+
+inline glm::vec3 Density::toPolar(glm::vec2 point, float radius, float lateral_projection_range, const int* dimension)
+{
+	return glm::vec3((point.x*2*M_PI)/dimension[0],asin(tanh(lateral_projection_range*(-0.5+point.y/dimension[1])))+M_PI_2,radius);
+}
+
+glm::vec3 Density::inverseBonne(glm::vec3 p, double standard_parallel, double central_meridian)
+{
+	double 	tmp = cot(standard_parallel),
+			rho = sgn(standard_parallel)*sqrt(pow(p.x,2)+pow(tmp-p.y,2)),
+			latitude = tmp+standard_parallel-rho;
+	return glm::vec3(central_meridian+rho*atan2(p.x,(tmp-p.y))/cos(latitude), latitude, p.z);
+}
+
+/*
+ * Pixels within the band width of a point, the same pixels whose calculateDensity counts the point. The
+ * criteria are symmetric, so BONNE and MERCATOR look up the pixels in a SphericalIndex of the pixel grid.
+ */
+struct DensityAccumulator::Footprints
+{
+	int type;
+	double radius, lateral_projection_range, band_width;
+	std::vector<int> dims, original_dims;
+	std::vector<int> pixels;	/* of the points of index */
+	std::unique_ptr<SphericalIndex> index;
+
+	glm::vec3 project(double x, double y) const
+	{
+		if(type == static_cast<int>(Density::density_type::CARTESIAN))
+			return glm::vec3(x/original_dims[0],y/original_dims[1],0);
+		return Density::toPolar(glm::vec2(x,y), radius, lateral_projection_range, original_dims.data());
 	}
-	if(feature_tensor != nullptr)
+	/* calls function(pixel) for the pixels counting the point */
+	template <typename Function>
+	void forEach(const glm::vec3 &p, Function function) const
 	{
-		for(int i=0; i< feature_tensor->getFlattenedLength(); ++i)
+		if(index != nullptr)
+		{
+			index->forEachWithin(p, band_width, [&](int k)
+			{
+				function(pixels[k]);
+			});
+			return;
+		}
+		// pixels of the square around p, widened by a pixel against rounding, tested exactly
+		double reach = band_width*band_width;
+		if(band_width < 0)
+			return;
+		int i0 = first(p.x-reach, dims[0]), i1 = last(p.x+reach, dims[0]),
+			j0 = first(p.y-reach, dims[1]), j1 = last(p.y+reach, dims[1]);
+		for(int j=j0; j<=j1; ++j)
 		{
-			feature_data[i] /= fmax(1, tensor_data[i]); //prevent division by 0
+			for(int i=i0; i<=i1; ++i)
+			{
+				glm::vec3 q = glm::vec3(double(i)/dims[0],double(j)/dims[1],0);
+				if(withinCartesianBandWidth(q, p, band_width))
+					function(i + j*dims[0]);
+			}
 		}
 	}
-	return feature_tensor;
-}
+	static int first(double x, int pixels)
+	{
+		return int(std::max(0., std::min(double(pixels), std::floor(x*pixels)-1)));
+	}
+	static int last(double x, int pixels)
+	{
+		return int(std::max(-1., std::min(double(pixels-1), std::ceil(x*pixels)+1)));
+	}
+};
 
-inline glm::vec3 Density::toPolar(glm::vec2 point, float radius, float lateral_projection_range, const int* dimension)
+DensityAccumulator::DensityAccumulator(Parameters &params)
 {
-	return glm::vec3((point.x*2*M_PI)/dimension[0],asin(tanh(lateral_projection_range*(-0.5+point.y/dimension[1])))+M_PI_2,radius);
+	int rank, type;
+	const Tensor<int> *dimensions, *original_dimensions;
+	double radius, lateral_projection_range, band_width, central_meridian, standard_parallel;
+	num_threads = params.getIntegerParameter("Threads");
+	if(
+		elib::isnan(rank = params.getIntegerParameter("Rank")) ||
+		(dimensions = params.getIntegerTensorParameter("Dimensions")) == nullptr ||
+		(original_dimensions = params.getIntegerTensorParameter("OriginalDimensions")) == nullptr ||
+		elib::isnan(radius = params.getDoubleParameter("Radius")) ||
+		elib::isnan(lateral_projection_range = params.getDoubleParameter("LateralProjectionRange")) ||
+		elib::isnan(band_width = params.getDoubleParameter("BandWidth")) ||
+		elib::isnan(type = params.getIntegerParameter("Type")) ||
+		elib::isnan(central_meridian = params.getDoubleParameter("CentralMeridian")) ||
+		elib::isnan(standard_parallel = params.getDoubleParameter("StandardParallel")) ||
+		rank != 2 || type < static_cast<int>(Density::density_type::BONNE) || type > static_cast<int>(Density::density_type::MERCATOR)
+	)
+	{
+		valid = false;
+		return;
+	}
+	int *dims = const_cast<Tensor<int>* >(dimensions)->getData();
+	int *original_dims = const_cast<Tensor<int>* >(original_dimensions)->getData();
+	this->dimensions.assign(dims, dims+2);
+	counts = std::vector<std::atomic<int>>(std::size_t(dims[0])*dims[1]);
+
+	footprints = std::unique_ptr<Footprints>(new Footprints());
+	footprints->type = type;
+	footprints->radius = radius;
+	footprints->lateral_projection_range = lateral_projection_range;
+	footprints->band_width = band_width;
+	footprints->dims.assign(dims, dims+2);
+	footprints->original_dims.assign(original_dims, original_dims+2);
+	if(type != static_cast<int>(Density::density_type::CARTESIAN))
+	{
+		std::shared_ptr<const ProjectionCache::Grid> grid = Density::getProjectionGrid(type, dims, radius, lateral_projection_range,
+				standard_parallel, central_meridian, num_threads);
+		std::vector<glm::vec3> coordinates;
+		for(std::size_t pixel=0; pixel<grid->coordinates.size(); ++pixel)
+		{
+			if(grid->inside[pixel])
+			{
+				coordinates.push_back(grid->coordinates[pixel]);
+				footprints->pixels.push_back(int(pixel));
+			}
+		}
+		footprints->index = std::unique_ptr<SphericalIndex>(new SphericalIndex(coordinates, band_width, radius));
+	}
 }
 
-inline double Density::greatCircleDistance(glm::vec3 p1, glm::vec3 p2)
+DensityAccumulator::~DensityAccumulator()
 {
-	return p1.z*2*asin(
-				sqrt(
-					haversine((p2.y-M_PI_2)-(p1.y-M_PI_2)) + cos(p1.y-M_PI_2)*cos(p2.y-M_PI_2)*haversine(p2.x-p1.x)
-				)
-			);
 }
-inline bool Density::bonneRegionFunction(glm::vec3 p, double standard_parallel, double central_meridian)
+
+bool DensityAccumulator::update(const Tensor<double> &tracks)
 {
-	glm::vec3 tmp=inverseBonne(p, standard_parallel, central_meridian);
-	return 	fabs(tmp.y)<=M_PI_2 && fabs(tmp.x)<=M_PI;
+	if(!valid)
+		return false;
+	const double *track_data = const_cast<Tensor<double>&>(tracks).getData();
+	int num_rows = 0;
+	if(tracks.getFlattenedLength() > 0)
+	{
+		if(tracks.getRank() != 2 || (*tracks.getDimensions())[1] != 3)
+			return false;
+		num_rows = (*tracks.getDimensions())[0];
+	}
+	// track ids are exact in a double up to 2^53
+	const double MAX_TRACK = 9007199254740992.;
+	std::unordered_map<long long, std::pair<double, double>> current(num_rows);
+	for(int row=0; row<num_rows; ++row)
+	{
+		const double *r = track_data + 3*std::size_t(row);
+		if(!(std::fabs(r[0]) <= MAX_TRACK) || r[0] != std::floor(r[0]) || !std::isfinite(r[1]) || !std::isfinite(r[2]))
+			return false;
+		if(!current.emplace((long long)r[0], std::make_pair(r[1], r[2])).second)
+			return false;
+	}
+
+	// footprints to add (+1) or remove (-1)
+	struct Change
+	{
+		double x, y;
+		int sign;
+	};
+	std::vector<Change> changes;
+	changed_points = 0;
+	for(const auto &track : current)
+	{
+		auto previous = positions.find(track.first);
+		if(previous == positions.end())
+		{
+			++changed_points;
+			changes.push_back({track.second.first, track.second.second, 1});
+		}
+		else if(previous->second != track.second)
+		{
+			++changed_points;
+			changes.push_back({previous->second.first, previous->second.second, -1});
+			changes.push_back({track.second.first, track.second.second, 1});
+		}
+	}
+	for(const auto &track : positions)
+	{
+		if(current.find(track.first) == current.end())
+		{
+			++changed_points;
+			changes.push_back({track.second.first, track.second.second, -1});
+		}
+	}
+	parallelFor(0, int(changes.size()), [&](int c)
+	{
+		footprints->forEach(footprints->project(changes[c].x, changes[c].y), [&](int pixel)
+		{
+			counts[pixel].fetch_add(changes[c].sign, std::memory_order_relaxed);
+		});
+	}, num_threads);
+	positions.swap(current);
+	return true;
 }
-glm::vec3 Density::inverseBonne(glm::vec3 p, double standard_parallel, double central_meridian)
+
+Tensor<double>* DensityAccumulator::getDensity() const
 {
-	double 	tmp = cot(standard_parallel),
-			rho = sgn(standard_parallel)*sqrt(pow(p.x,2)+pow(tmp-p.y,2)),
-			latitude = tmp+standard_parallel-rho;
-	return glm::vec3(central_meridian+rho*atan2(p.x,(tmp-p.y))/cos(latitude), latitude, p.z);
+	if(!valid)
+		return nullptr;
+	Tensor<double> *density = new Tensor<double>(2, dimensions);
+	double *density_data = density->getData();
+	for(std::size_t pixel=0; pixel<counts.size(); ++pixel)
+	{
+		density_data[pixel] = counts[pixel].load(std::memory_order_relaxed);
+	}
+	return density;
 }
 
 } /* namespace elib */
@@ -8,9 +8,14 @@
 #ifndef DENSITY_HPP_
 #define DENSITY_HPP_
 
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "glm/glm.hpp"
+#include "alg/projection_cache.hpp"
 #include "utilities/parameters.hpp"
 #include "templates/tensor.hpp"
 
@@ -20,16 +25,87 @@ namespace elib
 class Density
 {
 	public:
+		/*
+		 * Rows are computed concurrently, using the optional integer parameter "Threads" (0 = all hardware threads),
+		 * and only points bucketed near a pixel are tested. The pixel coordinates of BONNE and MERCATOR are
+		 * taken from the ProjectionCache.
+		 */
 		static elib::Tensor<double>* calculateDensity(elib::Tensor<double> &points, elib::Parameters &params);
 		static elib::Tensor<double>* calculateFeatureMap(elib::Tensor<double> &points, elib::Tensor<double> &features, elib::Parameters &params);
+		/*
+		 * Feature maps of all columns of a points x features matrix (or a vector of one feature) for several
+		 * band widths, sharing the projection and the neighbour search. Returns a tensor of dimensions
+		 * {band widths, features+1, Dimensions}, holding the averaged features followed by the point count
+		 * for every band width. Uses the parameters of calculateFeatureMap except "BandWidth".
+		 */
+		static elib::Tensor<double>* calculateFeatureMaps(elib::Tensor<double> &points, elib::Tensor<double> &features, elib::Tensor<double> &band_widths, elib::Parameters &params);
 
 		enum class density_type {BONNE, CARTESIAN, MERCATOR};
+		/*
+		 * Integer parameter "Kernel" of calculateDensity, DISK counts the points within the band width. The smooth
+		 * kernels are only available for CARTESIAN, where the points are binned onto the pixels and convolved by
+		 * FFT. They are scaled to 1 at the centre, the Gaussian has the disk radius as standard deviation and is
+		 * cut off at 4 of them, the Epanechnikov kernel has the support of the disk.
+		 */
+		enum class kernel_type {DISK, GAUSSIAN, EPANECHNIKOV};
 	private:
+		friend class DensityAccumulator;
+
+		/* sphere coordinates of the output pixels of a BONNE or MERCATOR density */
+		static std::shared_ptr<const ProjectionCache::Grid> getProjectionGrid(int type, const int *dims, double radius,
+				double lateral_projection_range, double standard_parallel, double central_meridian, int num_threads);
 		static inline glm::vec3 toPolar(glm::vec2 point, float radius, float lateral_projection_range, const int* dimension);
-		static inline double greatCircleDistance(glm::vec3 p1, glm::vec3 p2);
-		static inline bool bonneRegionFunction(glm::vec3 p, double standard_parallel, double central_meridian);
 		static glm::vec3 inverseBonne(glm::vec3 p, double standard_parallel, double central_meridian);
 };
 
+/*
+ * DISK density of a changing point set, e.g. the positions of tracks over time. The count of every pixel
+ * is kept and update only adds and removes the footprints, the pixels within the band width, of the tracks
+ * that appeared, ended or moved, so the pixel work of a frame is proportional to the number of changed
+ * tracks. The densities equal those of calculateDensity for the current points. Uses the parameters of
+ * calculateDensity except "Kernel".
+ */
+class DensityAccumulator
+{
+	public:
+		DensityAccumulator(Parameters &params);
+		virtual ~DensityAccumulator();
+
+		/*
+		 * replaces the points by rows (track, x, y), coordinates as for calculateDensity, comparing them with
+		 * the previous call by track, an empty tensor removes all points. Returns false and keeps the points
+		 * if a parameter is missing or invalid, or tracks is not an n x 3 matrix of distinct integral tracks
+		 * and finite coordinates.
+		 */
+		bool update(const Tensor<double> &tracks);
+		/* nullptr if a parameter is missing or invalid */
+		Tensor<double>* getDensity() const;
+		/* false if a parameter is missing or invalid, then update and getDensity fail */
+		bool isValid() const
+		{
+			return valid;
+		}
+		int getNumberOfPoints() const
+		{
+			return int(positions.size());
+		}
+		/* number of tracks added, removed or moved by the last successful call of update */
+		int getNumberOfChangedPoints() const
+		{
+			return changed_points;
+		}
+
+	private:
+		struct Footprints;
+
+		bool valid = true;
+		int num_threads;
+		std::vector<int> dimensions;
+		std::unique_ptr<Footprints> footprints;
+		std::unordered_map<long long, std::pair<double, double>> positions;	/* of the tracks */
+		std::vector<std::atomic<int>> counts;
+		int changed_points = 0;
+};
+
 } /* namespace elib */
 #endif /* DENSITY_HPP_ */
@@ -8,62 +8,43 @@
 #include "graphcut.hpp"
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
+#include "alg/grid_graph.hpp"
+#include "alg/intensity_histograms.hpp"
 #include "maxflow/energy.h"
 #include "maxflow/graph.h"
+#include "templates/pairwise_weight_table.hpp"
 #include "utilities/math_functions.hpp"
+#include "utilities/parallel.hpp"
+#include "utilities/profile.hpp"
 
 namespace elib{
 
-#define GC_INFINITY 300000.
-
-Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
+namespace
 {
-	using graphcut::Energy;
 
-	Image<short> *binary_image = new Image<short>(input_image.getRank(), *input_image.getDimensions(), input_image.getBitDepth(), input_image.getChannels());
-	int *nh,
-		nh_length,
-		nh2d[24] = {-1,0,0,-1,-1,0,0,-1,0,1,-1,0,1,0,0,1,1,0,0,1,0,-1,1,0}, // 8-neighborhood indices
-		nh3d[42] = {-1,0,0,0,0,-1,1,0,0,0,0,1,0,1,0,0,-1,0,-1,1,-1,1,1,-1,-1,1,1,1,1,1,-1,-1,-1,1,-1,-1,-1,-1,1,1,-1,1};
-	if(input_image.getRank()==2)
-	{
-		nh=nh2d;
-		nh_length=24;
-	}
-	else
-	{
-		nh=nh3d;
-		nh_length=42;
-	}
-	int width = input_image.getWidth(),
-		height = input_image.getHeight(),
-        depth = input_image.getDepth(),
-        bitDepth = input_image.getBitDepth();
-    
-	double c0, c1, lambda, sigma;
-	if(
-		elib::isnan(c0 = parameters.getDoubleParameter("C0")) ||
-		elib::isnan(c1 = parameters.getDoubleParameter("C1")) ||
-        elib::isnan(lambda = parameters.getDoubleParameter("Lambda")) ||
-        elib::isnan(sigma = parameters.getDoubleParameter("Sigma"))
-	)
-	{
-		return nullptr;
-	}
+int nh2d[24] = {-1,0,0,-1,-1,0,0,-1,0,1,-1,0,1,0,0,1,1,0,0,1,0,-1,1,0}, // 8-neighborhood indices
+	nh3d[42] = {-1,0,0,0,0,-1,1,0,0,0,0,1,0,1,0,0,-1,0,-1,1,-1,1,1,-1,-1,1,1,1,1,1,-1,-1,-1,1,-1,-1,-1,-1,1,1,-1,1};
 
-	int *input_image_data = input_image.getData();
-	short *binary_image_data = binary_image->getData();
+/*
+ * Builds and minimizes the binary energy with the generic maxflow graph. unary(node, E0, E1) returns the
+ * costs for label 0 and 1 of a node, pairwise(node, other) the weight of the term |x_node - x_other|.
+ */
+template <typename BinaryImage, typename UnaryTerm, typename PairwiseTerm>
+void minimizeEnergy(BinaryImage &binary_image, int width, int height, int depth, const int *nh, int nh_length, UnaryTerm unary, PairwiseTerm pairwise)
+{
+	using graphcut::Energy;
 
+	ScopedTimer build_timer("graphcut build");
 	/****** Create the Energy *************************/
 	Energy::Var *varx = new Energy::Var[width*height*depth];
 	Energy *energy = new Energy();
 
-    int nodeCount;
-    float value;
-    float maxIntensity = powf(2.,bitDepth)-1.;
-    float bg = c0*maxIntensity,
-          fg = c1*maxIntensity;
+	int nodeCount;
+	Energy::Value value, e0, e1;
 	/****** Build Unary Term *************************/
 	for(int k=0; k<depth; ++k )
 	{
@@ -77,15 +58,15 @@ Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
 				varx[nodeCount] = energy->add_variable();
 
 				// add likelihood
-				value = input_image_data[nodeCount];
-				energy->add_term1(varx[nodeCount], (1-lambda)*fabsf(value - bg)/maxIntensity, (1-lambda)*fabsf(value - fg)/maxIntensity);
+				unary(nodeCount, e0, e1);
+				energy->add_term1(varx[nodeCount], e0, e1);
 			}
 		}
 	}
 
 	/******* Build pairwise terms ********************/
 	int other;
-    int x, y, z;
+	int x, y, z;
 	for(int k=0; k<depth; ++k)
 	{
 		for (int j=0; j<height; ++j)
@@ -102,7 +83,7 @@ Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
 					other = x + y*width + z*width*height;
 					if (!(x<0 || x>=width || y<0 || y>=height || z<0 || z>=depth))
 					{
-						value = lambda*expf(-powf(float(input_image_data[nodeCount] - input_image_data[other])/maxIntensity,2)/sigma);
+						value = pairwise(nodeCount, other);
 						energy->add_term2(varx[nodeCount], varx[other], 0., value, value, 0.);
 					}
 				}
@@ -110,10 +91,15 @@ Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
 		}
 	}
 
+	build_timer.stop();
 	/******* Minimize energy ********************/
-	energy->minimize();
+	{
+		ScopedTimer timer("graphcut maxflow");
+		energy->minimize();
+	}
 
 	/******* Show binary image and clean up ********************/
+	ScopedTimer labeling_timer("graphcut labeling");
 	for(int k=0; k<depth; ++k)
 	{
 		for (int j = 0; j < height; ++j)
@@ -123,11 +109,11 @@ Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
 				nodeCount = i + j * width + k*width*height;
 				if (energy->get_var(varx[nodeCount]))
 				{
-					binary_image_data[nodeCount] = 1;
+					binary_image.set(nodeCount, 1);
 				}
 				else
 				{
-					binary_image_data[nodeCount] = 0;
+					binary_image.set(nodeCount, 0);
 				}
 			}
 
@@ -136,84 +122,32 @@ Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
 
 	delete[] varx;
 	delete energy;
-
-	return binary_image;
 }
 
-void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_image, Parameters &parameters)
+/*
+ * Same energy as minimizeEnergy but solved with the GridGraph, where node and arc indices are implicit.
+ * Both directions of an edge end up in the same capacity slots, the resulting cut is identical.
+ * num_threads > 0 selects GridGraph::parallelMaxflow, which yields the same cut.
+ */
+template <typename BinaryImage, typename UnaryTerm, typename PairwiseTerm>
+void minimizeGridEnergy(BinaryImage &binary_image, int width, int height, int depth, const int *nh, int nh_length, UnaryTerm unary, PairwiseTerm pairwise, int num_threads = 0)
 {
-	using graphcut::Energy;
-
-	const Tensor<float> *background, *foreground;
-	float lambda, sigma;
-	if(
-		(background=parameters.getFloatTensorParameter("C0")) == nullptr ||
-		(foreground=parameters.getFloatTensorParameter("C1")) == nullptr ||
-		elib::isnan(lambda=parameters.getDoubleParameter("Lambda")) ||
-		elib::isnan(sigma=parameters.getDoubleParameter("Sigma"))
-	)
-	{
-		binary_image = nullptr;
-		return;
-	}
-	int width = input_image.getWidth(),
-		height = input_image.getHeight(),
-		depth = input_image.getDepth(),
-		bit_depth = input_image.getBitDepth();
-
-	if(background->getFlattenedLength() != (pow(2,bit_depth)) || foreground->getFlattenedLength() != (pow(2,bit_depth)))
-	{
-		binary_image = nullptr;
-		return;
-	}
-
-	int *input_image_data = input_image.getData();
-	binary_image = std::unique_ptr<Image<short>>(new Image<short>(input_image.getRank(), *input_image.getDimensions(), 8, 1));
-	short *binary_image_data = binary_image->getData();
-
-	/****** Create the Energy *************************/
-	Energy::Var *varx = new Energy::Var[width*height*depth];
-	Energy *energy = new Energy();
+	ScopedTimer build_timer("graphcut build");
+	GridGraph graph(width, height, depth, nh, nh_length);
+	ScopedAllocation graph_allocation(GridGraph::bytesPerNode(graph.getNumberOfDirections())*graph.getNumberOfNodes());
 
 	int nodeCount;
-	int value;
+	GridGraph::captype value, e0, e1;
 	/****** Build Unary Term *************************/
-	for(int k=0; k<depth; ++k )
+	for(nodeCount=0; nodeCount<graph.getNumberOfNodes(); ++nodeCount)
 	{
-		for (int j=0; j < height; ++j)
-		{
-			for (int i = 0; i < width; ++i)
-			{
-				nodeCount = i + j*width + k*width*height;
-
-				// add node
-				varx[nodeCount] = energy->add_variable();
-
-				// add likelihood
-				value = input_image_data[nodeCount];
-				energy->add_term1(varx[nodeCount], (1-lambda)*(1.-background->get(value)), (1-lambda)*(1.-foreground->get(value)));
-			}
-		}
+		unary(nodeCount, e0, e1);
+		graph.addTWeights(nodeCount, e1, e0);
 	}
 
-	int *nh,
-		nh_length,
-		nh2d[24] = {-1,0,0,-1,-1,0,0,-1,0,1,-1,0,1,0,0,1,1,0,0,1,0,-1,1,0}, // 8-neighborhood indices
-		nh3d[42] = {-1,0,0,0,0,-1,1,0,0,0,0,1,0,1,0,0,-1,0,-1,1,-1,1,1,-1,-1,1,1,1,1,1,-1,-1,-1,1,-1,-1,-1,-1,1,1,-1,1};
-	if(input_image.getRank()==2)
-	{
-		nh=nh2d;
-		nh_length=24;
-	}
-	else
-	{
-		nh=nh3d;
-		nh_length=42;
-	}
 	/******* Build pairwise terms ********************/
 	int other;
 	int x, y, z;
-    float maxIntensity = powf(2.,input_image.getBitDepth())-1.;
 	for(int k=0; k<depth; ++k)
 	{
 		for (int j=0; j<height; ++j)
@@ -230,41 +164,236 @@ void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_ima
 					other = x + y*width + z*width*height;
 					if (!(x<0 || x>=width || y<0 || y>=height || z<0 || z>=depth))
 					{
-						value = lambda*expf(-powf(float(input_image_data[nodeCount] - input_image_data[other])/maxIntensity,2)/sigma);
-						energy->add_term2(varx[nodeCount], varx[other], 0., value, value, 0.);
+						value = pairwise(nodeCount, other);
+						graph.addEdge(nodeCount, l/3, value, value);
 					}
 				}
 			}
 		}
 	}
 
+	build_timer.stop();
 	/******* Minimize energy ********************/
-	energy->minimize();
+	{
+		ScopedTimer timer("graphcut maxflow");
+		if(num_threads > 0)
+			graph.parallelMaxflow(num_threads);
+		else
+			graph.maxflow();
+	}
 
-	/******* Show binary image and clean up ********************/
-	for(int k=0; k<depth; ++k)
+	ScopedTimer labeling_timer("graphcut labeling");
+	for(nodeCount=0; nodeCount<graph.getNumberOfNodes(); ++nodeCount)
 	{
-		for (int j = 0; j < height; ++j)
-		{
-			for (int i = 0; i < width; ++i)
-			{
-				nodeCount = i + j * width + k*width*height;
-				if (energy->get_var(varx[nodeCount]))
-				{
-					binary_image_data[nodeCount] = 1;
-				}
-				else
-				{
-					binary_image_data[nodeCount] = 0;
-				}
-			}
+		binary_image.set(nodeCount, (graph.whatSegment(nodeCount) == GridGraph::SINK) ? 1 : 0);
+	}
+}
+
+template <typename BinaryImage, typename UnaryTerm, typename PairwiseTerm>
+void minimize(graphcut_solver solver, int num_threads, BinaryImage &binary_image, int rank, int width, int height, int depth, UnaryTerm unary, PairwiseTerm pairwise)
+{
+	int *nh,
+		nh_length;
+	if(rank==2)
+	{
+		nh=nh2d;
+		nh_length=24;
+	}
+	else
+	{
+		nh=nh3d;
+		nh_length=42;
+	}
+	switch(solver)
+	{
+		case graphcut_solver::GRID:
+			minimizeGridEnergy(binary_image, width, height, depth, nh, nh_length, unary, pairwise);
+			break;
+		case graphcut_solver::PARALLEL_GRID:
+			minimizeGridEnergy(binary_image, width, height, depth, nh, nh_length, unary, pairwise,
+					num_threads > 0 ? num_threads : defaultNumberOfThreads());
+			break;
+		default:
+			minimizeEnergy(binary_image, width, height, depth, nh, nh_length, unary, pairwise);
+			break;
+	}
+}
+
+} /* end anonymous namespace */
+
+std::size_t graphcutBytesPerVoxel(int rank)
+{
+	int length;
+	const int *nh = graphcutNeighbourhood(rank, length);
+	GridGraph graph(1, 1, 1, nh, length);
+	return sizeof(int) + sizeof(short) + GridGraph::bytesPerNode(graph.getNumberOfDirections());
+}
+
+const int* graphcutNeighbourhood(int rank, int &length)
+{
+	length = rank==2 ? 24 : 42;
+	return rank==2 ? nh2d : nh3d;
+}
+
+Image<short>* graphcut(Image<int> &input_image, Parameters &parameters)
+{
+	Image<short> *binary_image = new Image<short>(input_image.getRank(), *input_image.getDimensions(), input_image.getBitDepth(), input_image.getChannels());
+	if(!graphcut(input_image, *binary_image, parameters))
+	{
+		delete binary_image;
+		return nullptr;
+	}
+	return binary_image;
+}
+
+void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_image, Parameters &parameters)
+{
+	binary_image = std::unique_ptr<Image<short>>(new Image<short>(input_image.getRank(), *input_image.getDimensions(), 8, 1));
+	if(!graphcutDistribution(input_image, *binary_image, parameters))
+	{
+		binary_image = nullptr;
+	}
+}
+
+void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_image, Image<int> &label_image, Parameters &parameters)
+{
+	int num_intensities = pow(2, input_image.getBitDepth());
+	std::vector<float> background, foreground;
+	intensityHistograms(label_image, input_image, num_intensities, background, foreground,
+			std::max(0., parameters.getDoubleParameter("HistogramSmoothing")), parameters.getIntegerParameter("Threads"));
+	Tensor<float> c0(1, std::vector<int>{num_intensities}, background.data()),
+		c1(1, std::vector<int>{num_intensities}, foreground.data());
+	Parameters distribution_parameters(parameters);
+	distribution_parameters.addParameter("C0", c0);
+	distribution_parameters.addParameter("C1", c1);
+	graphcut(binary_image, input_image, distribution_parameters);
+}
 
+template <typename InputImage, typename BinaryImage>
+bool graphcut(const InputImage &input_image, BinaryImage &binary_image, Parameters &parameters)
+{
+	int width = input_image.getWidth(),
+		height = input_image.getHeight(),
+        depth = input_image.getDepth(),
+        bitDepth = input_image.getBitDepth();
+    
+	double c0, c1, lambda, sigma;
+	if(
+		elib::isnan(c0 = parameters.getDoubleParameter("C0")) ||
+		elib::isnan(c1 = parameters.getDoubleParameter("C1")) ||
+        elib::isnan(lambda = parameters.getDoubleParameter("Lambda")) ||
+        elib::isnan(sigma = parameters.getDoubleParameter("Sigma"))
+	)
+	{
+		return false;
+	}
+	graphcut_solver solver = static_cast<graphcut_solver>(parameters.getIntegerParameter("Solver"));
+	int num_threads = parameters.getIntegerParameter("Threads");
+
+    float maxIntensity = powf(2.,bitDepth)-1.;
+    float bg = c0*maxIntensity,
+          fg = c1*maxIntensity;
+	PairwiseWeightTable<float> weights(bitDepth, [&](int difference) -> float
+	{
+		return lambda*expf(-powf(float(difference)/maxIntensity,2)/sigma);
+	});
+	minimize(solver, num_threads, binary_image, input_image.getRank(), width, height, depth,
+		[&](int node, float &e0, float &e1)
+		{
+			float value = input_image.get(node);
+			e0 = (1-lambda)*fabsf(value - bg)/maxIntensity;
+			e1 = (1-lambda)*fabsf(value - fg)/maxIntensity;
+		},
+		[&](int node, int other) -> float
+		{
+			return weights(input_image.get(node), input_image.get(other));
 		}
+	);
+
+	return true;
+}
+
+template <typename InputImage, typename BinaryImage>
+bool graphcutDistribution(const InputImage &input_image, BinaryImage &binary_image, Parameters &parameters)
+{
+	const Tensor<float> *background, *foreground;
+	float lambda, sigma;
+	if(
+		(background=parameters.getFloatTensorParameter("C0")) == nullptr ||
+		(foreground=parameters.getFloatTensorParameter("C1")) == nullptr ||
+		elib::isnan(lambda=parameters.getDoubleParameter("Lambda")) ||
+		elib::isnan(sigma=parameters.getDoubleParameter("Sigma"))
+	)
+	{
+		return false;
 	}
+	graphcut_solver solver = static_cast<graphcut_solver>(parameters.getIntegerParameter("Solver"));
+	int num_threads = parameters.getIntegerParameter("Threads");
+	int width = input_image.getWidth(),
+		height = input_image.getHeight(),
+		depth = input_image.getDepth(),
+		bit_depth = input_image.getBitDepth();
 
-	delete[] varx;
-	delete energy;
+	if(background->getFlattenedLength() != (pow(2,bit_depth)) || foreground->getFlattenedLength() != (pow(2,bit_depth)))
+	{
+		return false;
+	}
+
+    float maxIntensity = powf(2.,input_image.getBitDepth())-1.;
+	PairwiseWeightTable<float> weights(bit_depth, [&](int difference) -> float
+	{
+		int value = lambda*expf(-powf(float(difference)/maxIntensity,2)/sigma);
+		return value;
+	});
+	minimize(solver, num_threads, binary_image, input_image.getRank(), width, height, depth,
+		[&](int node, float &e0, float &e1)
+		{
+			int value = input_image.get(node);
+			e0 = (1-lambda)*(1.-background->get(value));
+			e1 = (1-lambda)*(1.-foreground->get(value));
+		},
+		[&](int node, int other) -> float
+		{
+			return weights(input_image.get(node), input_image.get(other));
+		}
+	);
+	return true;
 }
+
+template <typename T>
+bool graphcutBatch(const T *frames, T *binary, int num_frames, const std::vector<int> &dimensions, int bit_depth,
+		Parameters &parameters, int num_threads)
+{
+	std::size_t frame_length = 1;
+	for(int d : dimensions)
+	{
+		frame_length *= d;
+	}
+	Parameters frame_parameters(parameters);
+	frame_parameters.addParameter("Threads", 1); // one thread per frame
+	std::atomic<bool> failed(false);
+	parallelFor(0, num_frames, [&](int frame)
+	{
+		ImageView<int, T> input_image(const_cast<T*>(frames) + frame*frame_length, dimensions, bit_depth, 1);
+		ImageView<short, T> binary_image(binary + frame*frame_length, dimensions, bit_depth, 1);
+		if(!graphcut(input_image, binary_image, frame_parameters))
+		{
+			failed = true;
+		}
+	}, num_threads);
+	return !failed;
+}
+
+// views are instantiated for both 64 bit integer types, the one mint is defined as depends on the platform
+template bool graphcut(const Image<int>&, Image<short>&, Parameters&);
+template bool graphcut(const ImageView<int, long>&, ImageView<short, long>&, Parameters&);
+template bool graphcut(const ImageView<int, long long>&, ImageView<short, long long>&, Parameters&);
+template bool graphcutDistribution(const Image<int>&, Image<short>&, Parameters&);
+template bool graphcutDistribution(const ImageView<int, long>&, ImageView<short, long>&, Parameters&);
+template bool graphcutDistribution(const ImageView<int, long long>&, ImageView<short, long long>&, Parameters&);
+template bool graphcutBatch(const long*, long*, int, const std::vector<int>&, int, Parameters&, int);
+template bool graphcutBatch(const long long*, long long*, int, const std::vector<int>&, int, Parameters&, int);
+
 void graphcutSphere(int* binary, int nVertices, double *vertices, int *prior, int nNeighbors, int *neighbours, int bitDepth, int *intensities, double c0, double c1, double lambda1, double lambda2)
 {
 	using graphcut::Energy;
@@ -340,6 +469,10 @@ double calculateEnergy(int *image, int* binary, int width, int height, int bitDe
 	maxIntensity = pow(2,bitDepth)-1;
 	bg = c0*maxIntensity;
 	fg = c1*maxIntensity;
+	PairwiseWeightTable<double> weights(bitDepth, [&](int difference) -> double
+	{
+		return lambda1 + lambda2 * exp(-beta * pow(difference, 2));
+	});
 
 	/****** Build Unary Term *************************/
 	for (int j = 0; j < height; ++j)
@@ -366,7 +499,7 @@ double calculateEnergy(int *image, int* binary, int width, int height, int bitDe
 				{
 					if(binary[nodeCount]!=binary[x + y * width])
 					{
-						value = lambda1 + lambda2 * exp(-beta * pow(image[nodeCount] - image[x + y * width], 2));
+						value = weights(image[nodeCount], image[x + y * width]);
 						energy += value;
 					}
 				}
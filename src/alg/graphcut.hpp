@@ -9,14 +9,50 @@
 #define GRAPHCUTIMAGE_HPP_
 
 #include <math.h>
+#include <vector>
 
 #include "templates/image.hpp"
+#include "templates/image_view.hpp"
 #include "utilities/parameters.hpp"
 
 namespace elib{
 
+/* cost of a forbidden label, the prior of graphcut and the constraints of the multi label graph cut */
+constexpr double GC_INFINITY = 300000.;
+
+/*
+ * maxflow implementation used by graphcut, selected by the integer parameter "Solver";
+ * PARALLEL_GRID uses the integer parameter "Threads" (0 = all hardware threads)
+ */
+enum class graphcut_solver {GENERIC, GRID, PARALLEL_GRID};
+
 Image<short>* graphcut(Image<int> &input_image, Parameters &params);
 void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_image, Parameters &parameters);
+/*
+ * Same cut with the distributions "C0" and "C1" estimated from the background (label 0) and the foreground of
+ * label_image, optionally smoothed with the standard deviation "HistogramSmoothing" in intensity levels.
+ */
+void graphcut(std::unique_ptr<Image<short>> &binary_image, Image<int> &input_image, Image<int> &label_image, Parameters &parameters);
+/*
+ * Same cuts writing to a preallocated binary_image of the size of input_image, returning false if a parameter is
+ * missing. Instantiated for Image<int>/Image<short> and for views on 64 bit integer (MTensor) data.
+ */
+template <typename InputImage, typename BinaryImage>
+bool graphcut(const InputImage &input_image, BinaryImage &binary_image, Parameters &parameters);
+template <typename InputImage, typename BinaryImage>
+bool graphcutDistribution(const InputImage &input_image, BinaryImage &binary_image, Parameters &parameters);
+/*
+ * Cuts num_frames frames of the given dimensions stored one after another in frames, writing the labels to the
+ * same positions of binary. Frames are cut concurrently on num_threads threads (0 = all), each single threaded.
+ * Returns false if a parameter is missing. Instantiated for 64 bit integer (MTensor) data.
+ */
+template <typename T>
+bool graphcutBatch(const T *frames, T *binary, int num_frames, const std::vector<int> &dimensions, int bit_depth,
+		Parameters &parameters, int num_threads);
+/* peak memory of graphcut per voxel with the GRID solvers, including input and result image */
+std::size_t graphcutBytesPerVoxel(int rank);
+/* neighbourhood offsets (triples dx,dy,dz) used by graphcut for images of the given rank */
+const int* graphcutNeighbourhood(int rank, int &length);
 void graphcutSphere(int* binary, int nVertices, double *vertices, int *prior, int nNeighbors, int *neighbours, int bitDepth, int *intensities, double c0, double c1, double lambda1, double lambda2);
 double calculateEnergy(int *image, int* binary, int width, int height, int bitDepth, double c0, double c1, double lambda1, double lambda2, double beta);
 double calculateError(int *binaryLabel, int *groundTruthLabel, int width, int height);
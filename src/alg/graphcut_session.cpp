@@ -0,0 +1,138 @@
+/*
+ * graphcut_session.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "graphcut_session.hpp"
+
+#include <math.h>
+
+#include "alg/graphcut.hpp"
+#include "utilities/math_functions.hpp"
+
+namespace elib{
+
+GraphCutSession::GraphCutSession(Parameters &parameters)
+{
+	if(
+		elib::isnan(c0 = parameters.getDoubleParameter("C0")) ||
+		elib::isnan(c1 = parameters.getDoubleParameter("C1")) ||
+		elib::isnan(lambda = parameters.getDoubleParameter("Lambda")) ||
+		elib::isnan(sigma = parameters.getDoubleParameter("Sigma"))
+	)
+	{
+		valid = false;
+	}
+	num_threads = parameters.getIntegerParameter("Threads");
+}
+
+GraphCutSession::~GraphCutSession()
+{
+}
+
+Image<short>* GraphCutSession::cut(Image<int> &frame)
+{
+	if(!valid)
+		return nullptr;
+	if(graph == nullptr)
+	{
+		build(frame);
+	}
+	else
+	{
+		if(*frame.getDimensions() != dimensions || frame.getBitDepth() != bit_depth)
+			return nullptr;
+		update(frame);
+	}
+
+	if(num_threads > 0)
+		graph->parallelMaxflow(num_threads);
+	else
+		graph->maxflow();
+
+	Image<short> *binary_image = new Image<short>(frame.getRank(), dimensions, bit_depth, frame.getChannels());
+	short *binary_image_data = binary_image->getData();
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		binary_image_data[node] = (graph->whatSegment(node) == GridGraph::SINK) ? 1 : 0;
+	}
+	return binary_image;
+}
+
+void GraphCutSession::build(Image<int> &frame)
+{
+	dimensions = *frame.getDimensions();
+	bit_depth = frame.getBitDepth();
+	max_intensity = powf(2.,bit_depth)-1.;
+	bg = c0*max_intensity;
+	fg = c1*max_intensity;
+	weights = std::unique_ptr<PairwiseWeightTable<float>>(new PairwiseWeightTable<float>(bit_depth, [=](int difference) -> float
+	{
+		return lambda*expf(-powf(float(difference)/max_intensity,2)/sigma);
+	}));
+	nh = graphcutNeighbourhood(frame.getRank(), nh_length);
+	graph = std::unique_ptr<GridGraph>(new GridGraph(frame.getWidth(), frame.getHeight(), frame.getDepth(), nh, nh_length));
+	intensities.assign(frame.getData(), frame.getData() + frame.getFlattenedLength());
+
+	float e0, e1;
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		unary(intensities[node], e0, e1);
+		graph->addTWeights(node, e1, e0);
+	}
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		for(int l=0; l<nh_length; l+=3)
+		{
+			int other = graph->getNeighbour(node, l/3);
+			if(other >= 0)
+			{
+				float value = (*weights)(intensities[node], intensities[other]);
+				graph->addEdge(node, l/3, value, value);
+			}
+		}
+	}
+	changed_nodes = graph->getNumberOfNodes();
+}
+
+void GraphCutSession::update(Image<int> &frame)
+{
+	const int *data = frame.getData();
+	std::vector<unsigned char> changed(intensities.size(), 0);
+	float old_e0, old_e1, e0, e1;
+	changed_nodes = 0;
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		if(data[node] != intensities[node])
+		{
+			changed[node] = 1;
+			++changed_nodes;
+			unary(intensities[node], old_e0, old_e1);
+			unary(data[node], e0, e1);
+			graph->updateTWeights(node, e1-old_e1, e0-old_e0);
+		}
+	}
+	// every neighbourhood contains the opposite offsets, so each edge is visited from both of its nodes
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		if(!changed[node])
+			continue;
+		for(int l=0; l<nh_length; l+=3)
+		{
+			int other = graph->getNeighbour(node, l/3);
+			if(other >= 0 && (!changed[other] || node < other))
+			{
+				graph->setEdge(node, l/3, 2*(*weights)(data[node], data[other]));
+			}
+		}
+	}
+	for(int node=0; node<graph->getNumberOfNodes(); ++node)
+	{
+		if(changed[node])
+			intensities[node] = data[node];
+	}
+}
+
+} /* end namespace elib */
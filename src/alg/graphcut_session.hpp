@@ -0,0 +1,70 @@
+/*
+ * graphcut_session.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef GRAPHCUT_SESSION_HPP_
+#define GRAPHCUT_SESSION_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "alg/grid_graph.hpp"
+#include "templates/image.hpp"
+#include "templates/pairwise_weight_table.hpp"
+#include "utilities/parameters.hpp"
+
+namespace elib{
+
+/*
+ * Binary graph cut of consecutive frames with the energy of graphcut(Image<int>&, Parameters&).
+ *
+ * The graph of the first frame is kept alive. For every further frame only the terminal and
+ * neighbour links of pixels whose intensity changed are updated, keeping the flow of the previous
+ * frame, and maxflow only has to push the difference. Uses the parameters "C0", "C1", "Lambda",
+ * "Sigma" and optionally "Threads" (> 0 selects GridGraph::parallelMaxflow).
+ */
+class GraphCutSession
+{
+	public:
+		GraphCutSession(Parameters &parameters);
+		virtual ~GraphCutSession();
+
+		/* returns nullptr if a parameter is missing or the frame differs in size or bit depth from the first one */
+		Image<short>* cut(Image<int> &frame);
+		/* number of pixels whose links were updated by the last call of cut */
+		int getNumberOfChangedNodes() const
+		{
+			return changed_nodes;
+		}
+
+	private:
+		void build(Image<int> &frame);
+		void update(Image<int> &frame);
+		inline void unary(int intensity, float &e0, float &e1) const
+		{
+			e0 = (1-lambda)*fabsf(intensity - bg)/max_intensity;
+			e1 = (1-lambda)*fabsf(intensity - fg)/max_intensity;
+		}
+
+		bool valid = true;
+		double c0, c1, lambda, sigma;
+		int num_threads;
+
+		std::vector<int> dimensions;
+		int bit_depth = 0;
+		float max_intensity, bg, fg;
+		const int *nh = nullptr;
+		int nh_length = 0;
+		int changed_nodes = 0;
+
+		std::unique_ptr<GridGraph> graph;
+		std::unique_ptr<PairwiseWeightTable<float>> weights;
+		std::vector<int> intensities;	/* previous frame */
+};
+
+} /* end namespace elib */
+
+#endif /* GRAPHCUT_SESSION_HPP_ */
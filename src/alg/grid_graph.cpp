@@ -0,0 +1,606 @@
+/*
+ * grid_graph.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "grid_graph.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+#include "utilities/parallel.hpp"
+
+namespace elib{
+
+GridGraph::GridGraph(int width, int height, int depth, const int *neighbourhood, int neighbourhood_length)
+: width(width), height(height), depth(depth), num_nodes(width*height*depth)
+{
+	for(int l=0; l<neighbourhood_length; l+=3)
+	{
+		if(abs(neighbourhood[l]) > 1 || abs(neighbourhood[l+1]) > 1 || abs(neighbourhood[l+2]) > 1)
+		{
+			throw std::invalid_argument("GridGraph: neighbourhood offsets have to be in {-1,0,1}.");
+		}
+		dx.push_back(neighbourhood[l]);
+		dy.push_back(neighbourhood[l+1]);
+		dz.push_back(neighbourhood[l+2]);
+	}
+	//append missing reverse directions
+	for(unsigned int d=0; d<dx.size(); ++d)
+	{
+		unsigned int o;
+		for(o=0; o<dx.size(); ++o)
+		{
+			if(dx[o]==-dx[d] && dy[o]==-dy[d] && dz[o]==-dz[d])
+				break;
+		}
+		if(o == dx.size())
+		{
+			dx.push_back(-dx[d]);
+			dy.push_back(-dy[d]);
+			dz.push_back(-dz[d]);
+		}
+		opposite.push_back(o);
+	}
+	num_directions = int(dx.size());
+	if(num_directions > 32)
+	{
+		throw std::invalid_argument("GridGraph: at most 32 neighbourhood directions are supported.");
+	}
+	for(int d=0; d<num_directions; ++d)
+	{
+		delta.push_back(dx[d] + dy[d]*width + dz[d]*width*height);
+	}
+
+	// valid directions for each combination of boundary classes (bit 0: at lower bound, bit 1: at upper bound)
+	for(int c=0; c<64; ++c)
+	{
+		int cx = c & 3,
+			cy = (c >> 2) & 3,
+			cz = (c >> 4) & 3;
+		class_masks[c] = 0;
+		for(int d=0; d<num_directions; ++d)
+		{
+			if(	!(dx[d] < 0 && (cx & 1)) && !(dx[d] > 0 && (cx & 2)) &&
+				!(dy[d] < 0 && (cy & 1)) && !(dy[d] > 0 && (cy & 2)) &&
+				!(dz[d] < 0 && (cz & 1)) && !(dz[d] > 0 && (cz & 2)))
+			{
+				class_masks[c] |= 1u << d;
+			}
+		}
+	}
+
+	r_cap = std::vector<captype>(std::size_t(num_nodes)*num_directions, 0);
+	tr_cap = std::vector<captype>(num_nodes, 0);
+	parent = std::vector<signed char>(num_nodes, FREE);
+	is_sink = std::vector<unsigned char>(num_nodes, 0);
+	next = std::vector<int>(num_nodes, NONE);
+	TS = std::vector<int>(num_nodes, 0);
+	DIST = std::vector<int>(num_nodes, 0);
+}
+
+GridGraph::~GridGraph()
+{
+}
+
+void GridGraph::addTWeights(int node, captype cap_source, captype cap_sink)
+{
+	captype delta = tr_cap[node];
+	if (delta > 0) cap_source += delta;
+	else           cap_sink   -= delta;
+	flow += (cap_source < cap_sink) ? cap_source : cap_sink;
+	tr_cap[node] = cap_source - cap_sink;
+}
+
+void GridGraph::addEdge(int node, int direction, captype cap, captype rev_cap)
+{
+	r_cap[arc(node, direction)] += cap;
+	r_cap[sister(node, direction)] += rev_cap;
+}
+
+void GridGraph::updateTWeights(int node, captype delta_source, captype delta_sink)
+{
+	// the residual of the terminal links only matters up to a constant added to both
+	tr_cap[node] += delta_source - delta_sink;
+}
+
+void GridGraph::setEdge(int node, int direction, captype cap)
+{
+	std::size_t a = arc(node, direction), s = sister(node, direction);
+	captype f = (r_cap[a] - r_cap[s])/2;	/* flow from the neighbour to node */
+	r_cap[a] = cap + f;
+	r_cap[s] = cap - f;
+	// flow exceeding the new capacity is taken back and the excess/deficit moved to the terminal links
+	if(r_cap[a] < 0)
+	{
+		captype excess = -r_cap[a];
+		r_cap[a] = 0;
+		r_cap[s] = 2*cap;
+		tr_cap[node] += excess;
+		tr_cap[node + delta[direction]] -= excess;
+	}
+	else if(r_cap[s] < 0)
+	{
+		captype excess = -r_cap[s];
+		r_cap[s] = 0;
+		r_cap[a] = 2*cap;
+		tr_cap[node] -= excess;
+		tr_cap[node + delta[direction]] += excess;
+	}
+}
+
+GridGraph::termtype GridGraph::whatSegment(int node) const
+{
+	if (parent[node] != FREE && !is_sink[node]) return SOURCE;
+	return SINK;
+}
+
+int GridGraph::getNeighbour(int node, int direction) const
+{
+	if(validDirections(node) & (1u << direction))
+		return node + delta[direction];
+	return NONE;
+}
+
+std::size_t GridGraph::bytesPerNode(int num_directions)
+{
+	return num_directions*sizeof(captype) + sizeof(captype) + sizeof(signed char) + sizeof(unsigned char) + 3*sizeof(int);
+}
+
+/***********************************************************************/
+/*
+	Active nodes are kept in two queues linked through 'next' (see maxflow.cpp
+	of the generic solver). next[i] is NONE iff i is not in a queue, the last
+	node of a queue points to itself.
+*/
+
+inline void GridGraph::setActive(Region &r, int i)
+{
+	if (next[i] == NONE)
+	{
+		if (r.queue_last[1] != NONE) next[r.queue_last[1]] = i;
+		else                       r.queue_first[1]      = i;
+		r.queue_last[1] = i;
+		next[i] = i;
+	}
+}
+
+inline int GridGraph::nextActive(Region &r)
+{
+	int i;
+
+	while ( 1 )
+	{
+		if ((i=r.queue_first[0]) == NONE)
+		{
+			r.queue_first[0] = i = r.queue_first[1];
+			r.queue_last[0]  = r.queue_last[1];
+			r.queue_first[1] = NONE;
+			r.queue_last[1]  = NONE;
+			if (i == NONE) return NONE;
+		}
+
+		if (next[i] == i) r.queue_first[0] = r.queue_last[0] = NONE;
+		else              r.queue_first[0] = next[i];
+		next[i] = NONE;
+
+		/* a node in the list is active iff it has a parent */
+		if (parent[i] != FREE) return i;
+	}
+}
+
+void GridGraph::maxflowInit(Region &r)
+{
+	r.queue_first[0] = r.queue_last[0] = NONE;
+	r.queue_first[1] = r.queue_last[1] = NONE;
+	r.orphans.clear();
+
+	int first = r.plane_begin*planeSize(), last = r.plane_end*planeSize();
+	for (int i=first; i<last; ++i)
+	{
+		next[i] = NONE;
+		TS[i] = 0;
+		if (tr_cap[i] > 0)
+		{
+			is_sink[i] = 0;
+			parent[i] = TERMINAL;
+			setActive(r, i);
+			DIST[i] = 1;
+		}
+		else if (tr_cap[i] < 0)
+		{
+			is_sink[i] = 1;
+			parent[i] = TERMINAL;
+			setActive(r, i);
+			DIST[i] = 1;
+		}
+		else
+		{
+			parent[i] = FREE;
+		}
+	}
+	r.TIME = 0;
+}
+
+void GridGraph::augment(Region &r, int middle_node, int middle_direction)
+{
+	int i, d;
+	std::size_t a, middle_arc = arc(middle_node, middle_direction), middle_sister = sister(middle_node, middle_direction);
+	captype bottleneck;
+
+	/* 1. Finding bottleneck capacity */
+	/* 1a - the source tree */
+	bottleneck = r_cap[middle_arc];
+	for (i=middle_node; ; i+=delta[d])
+	{
+		d = parent[i];
+		if (d == TERMINAL) break;
+		a = sister(i, d);
+		if (bottleneck > r_cap[a]) bottleneck = r_cap[a];
+	}
+	if (bottleneck > tr_cap[i]) bottleneck = tr_cap[i];
+	/* 1b - the sink tree */
+	for (i=middle_node+delta[middle_direction]; ; i+=delta[d])
+	{
+		d = parent[i];
+		if (d == TERMINAL) break;
+		a = arc(i, d);
+		if (bottleneck > r_cap[a]) bottleneck = r_cap[a];
+	}
+	if (bottleneck > - tr_cap[i]) bottleneck = - tr_cap[i];
+
+	/* 2. Augmenting */
+	/* 2a - the source tree */
+	r_cap[middle_sister] += bottleneck;
+	r_cap[middle_arc] -= bottleneck;
+	for (i=middle_node; ; i+=delta[d])
+	{
+		d = parent[i];
+		if (d == TERMINAL) break;
+		r_cap[arc(i, d)] += bottleneck;
+		a = sister(i, d);
+		r_cap[a] -= bottleneck;
+		if (!r_cap[a])
+		{
+			parent[i] = ORPHAN;
+			r.orphans.push_front(i);
+		}
+	}
+	tr_cap[i] -= bottleneck;
+	if (!tr_cap[i])
+	{
+		parent[i] = ORPHAN;
+		r.orphans.push_front(i);
+	}
+	/* 2b - the sink tree */
+	for (i=middle_node+delta[middle_direction]; ; i+=delta[d])
+	{
+		d = parent[i];
+		if (d == TERMINAL) break;
+		r_cap[sister(i, d)] += bottleneck;
+		a = arc(i, d);
+		r_cap[a] -= bottleneck;
+		if (!r_cap[a])
+		{
+			parent[i] = ORPHAN;
+			r.orphans.push_front(i);
+		}
+	}
+	tr_cap[i] += bottleneck;
+	if (!tr_cap[i])
+	{
+		parent[i] = ORPHAN;
+		r.orphans.push_front(i);
+	}
+
+	r.flow += bottleneck;
+}
+
+void GridGraph::processSourceOrphan(Region &r, int i)
+{
+	int j, d0, d0_min = NONE, a, d, d_min = INFINITE_D;
+	unsigned int valid = validDirections(i, r);
+
+	/* trying to find a new parent */
+	for (d0=0; d0<num_directions; ++d0)
+	if ((valid & (1u << d0)) && r_cap[sister(i, d0)])
+	{
+		j = i + delta[d0];
+		if (!is_sink[j] && (a=parent[j]) != FREE)
+		{
+			/* checking the origin of j */
+			d = 0;
+			while ( 1 )
+			{
+				if (TS[j] == r.TIME)
+				{
+					d += DIST[j];
+					break;
+				}
+				a = parent[j];
+				d ++;
+				if (a==TERMINAL)
+				{
+					TS[j] = r.TIME;
+					DIST[j] = 1;
+					break;
+				}
+				if (a==ORPHAN) { d = INFINITE_D; break; }
+				j += delta[a];
+			}
+			if (d<INFINITE_D) /* j originates from the source - done */
+			{
+				if (d<d_min)
+				{
+					d0_min = d0;
+					d_min = d;
+				}
+				/* set marks along the path */
+				for (j=i+delta[d0]; TS[j]!=r.TIME; j+=delta[parent[j]])
+				{
+					TS[j] = r.TIME;
+					DIST[j] = d --;
+				}
+			}
+		}
+	}
+
+	if (d0_min != NONE)
+	{
+		parent[i] = d0_min;
+		TS[i] = r.TIME;
+		DIST[i] = d_min + 1;
+	}
+	else
+	{
+		/* no parent is found */
+		parent[i] = FREE;
+		TS[i] = 0;
+
+		/* process neighbors */
+		for (d0=0; d0<num_directions; ++d0)
+		if (valid & (1u << d0))
+		{
+			j = i + delta[d0];
+			if (!is_sink[j] && (a=parent[j]) != FREE)
+			{
+				if (r_cap[sister(i, d0)]) setActive(r, j);
+				if (a!=TERMINAL && a!=ORPHAN && j+delta[a]==i)
+				{
+					parent[j] = ORPHAN;
+					r.orphans.push_back(j);
+				}
+			}
+		}
+	}
+}
+
+void GridGraph::processSinkOrphan(Region &r, int i)
+{
+	int j, d0, d0_min = NONE, a, d, d_min = INFINITE_D;
+	unsigned int valid = validDirections(i, r);
+
+	/* trying to find a new parent */
+	for (d0=0; d0<num_directions; ++d0)
+	if ((valid & (1u << d0)) && r_cap[arc(i, d0)])
+	{
+		j = i + delta[d0];
+		if (is_sink[j] && (a=parent[j]) != FREE)
+		{
+			/* checking the origin of j */
+			d = 0;
+			while ( 1 )
+			{
+				if (TS[j] == r.TIME)
+				{
+					d += DIST[j];
+					break;
+				}
+				a = parent[j];
+				d ++;
+				if (a==TERMINAL)
+				{
+					TS[j] = r.TIME;
+					DIST[j] = 1;
+					break;
+				}
+				if (a==ORPHAN) { d = INFINITE_D; break; }
+				j += delta[a];
+			}
+			if (d<INFINITE_D) /* j originates from the sink - done */
+			{
+				if (d<d_min)
+				{
+					d0_min = d0;
+					d_min = d;
+				}
+				/* set marks along the path */
+				for (j=i+delta[d0]; TS[j]!=r.TIME; j+=delta[parent[j]])
+				{
+					TS[j] = r.TIME;
+					DIST[j] = d --;
+				}
+			}
+		}
+	}
+
+	if (d0_min != NONE)
+	{
+		parent[i] = d0_min;
+		TS[i] = r.TIME;
+		DIST[i] = d_min + 1;
+	}
+	else
+	{
+		/* no parent is found */
+		parent[i] = FREE;
+		TS[i] = 0;
+
+		/* process neighbors */
+		for (d0=0; d0<num_directions; ++d0)
+		if (valid & (1u << d0))
+		{
+			j = i + delta[d0];
+			if (is_sink[j] && (a=parent[j]) != FREE)
+			{
+				if (r_cap[arc(i, d0)]) setActive(r, j);
+				if (a!=TERMINAL && a!=ORPHAN && j+delta[a]==i)
+				{
+					parent[j] = ORPHAN;
+					r.orphans.push_back(j);
+				}
+			}
+		}
+	}
+}
+
+GridGraph::flowtype GridGraph::maxflow()
+{
+	Region r;
+	r.plane_begin = 0;
+	r.plane_end = numberOfPlanes();
+	maxflow(r);
+	flow += r.flow;
+	return flow;
+}
+
+GridGraph::flowtype GridGraph::parallelMaxflow(int num_threads)
+{
+	int num_planes = numberOfPlanes(),
+		num_regions = num_threads < num_planes ? num_threads : num_planes;
+	if(num_regions < 1)
+		num_regions = 1;
+	/*
+	 * Every round solves the regions independently, arcs between regions keep their residual
+	 * capacities. Neighbouring regions are merged for the next round, the last round covers the
+	 * whole grid and finds all remaining augmenting paths, so the cut equals the serial one.
+	 */
+	while(true)
+	{
+		std::vector<Region> regions(num_regions);
+		for(int k=0; k<num_regions; ++k)
+		{
+			regions[k].plane_begin = int((long long)num_planes*k/num_regions);
+			regions[k].plane_end = int((long long)num_planes*(k+1)/num_regions);
+		}
+		parallelFor(0, num_regions, [&](int k){ maxflow(regions[k]); }, num_regions);
+		for(auto &r : regions)
+			flow += r.flow;
+		if(num_regions == 1)
+			break;
+		num_regions = (num_regions+1)/2;
+	}
+	return flow;
+}
+
+void GridGraph::maxflow(Region &r)
+{
+	int i, j, d, current_node = NONE, middle_node = NONE, middle_direction = NONE;
+	unsigned int valid;
+
+	r.flow = 0;
+	maxflowInit(r);
+
+	while ( 1 )
+	{
+		if ((i=current_node) != NONE)
+		{
+			next[i] = NONE; /* remove active flag */
+			if (parent[i] == FREE) i = NONE;
+		}
+		if (i == NONE)
+		{
+			if ((i = nextActive(r)) == NONE) break;
+		}
+
+		/* growth */
+		middle_node = NONE;
+		valid = validDirections(i, r);
+		if (!is_sink[i])
+		{
+			/* grow source tree */
+			for (d=0; d<num_directions; ++d)
+			if ((valid & (1u << d)) && r_cap[arc(i, d)])
+			{
+				j = i + delta[d];
+				if (parent[j] == FREE)
+				{
+					is_sink[j] = 0;
+					parent[j] = opposite[d];
+					TS[j] = TS[i];
+					DIST[j] = DIST[i] + 1;
+					setActive(r, j);
+				}
+				else if (is_sink[j])
+				{
+					middle_node = i;
+					middle_direction = d;
+					break;
+				}
+				else if (TS[j] <= TS[i] &&
+				         DIST[j] > DIST[i])
+				{
+					/* heuristic - trying to make the distance from j to the source shorter */
+					parent[j] = opposite[d];
+					TS[j] = TS[i];
+					DIST[j] = DIST[i] + 1;
+				}
+			}
+		}
+		else
+		{
+			/* grow sink tree */
+			for (d=0; d<num_directions; ++d)
+			if ((valid & (1u << d)) && r_cap[sister(i, d)])
+			{
+				j = i + delta[d];
+				if (parent[j] == FREE)
+				{
+					is_sink[j] = 1;
+					parent[j] = opposite[d];
+					TS[j] = TS[i];
+					DIST[j] = DIST[i] + 1;
+					setActive(r, j);
+				}
+				else if (!is_sink[j])
+				{
+					middle_node = j;
+					middle_direction = opposite[d];
+					break;
+				}
+				else if (TS[j] <= TS[i] &&
+				         DIST[j] > DIST[i])
+				{
+					/* heuristic - trying to make the distance from j to the sink shorter */
+					parent[j] = opposite[d];
+					TS[j] = TS[i];
+					DIST[j] = DIST[i] + 1;
+				}
+			}
+		}
+
+		r.TIME ++;
+
+		if (middle_node != NONE)
+		{
+			next[i] = i; /* set active flag */
+			current_node = i;
+
+			augment(r, middle_node, middle_direction);
+
+			/* adoption */
+			while (!r.orphans.empty())
+			{
+				j = r.orphans.front();
+				r.orphans.pop_front();
+				if (is_sink[j]) processSinkOrphan(r, j);
+				else            processSourceOrphan(r, j);
+			}
+		}
+		else current_node = NONE;
+	}
+}
+
+} /* end namespace elib */
@@ -0,0 +1,158 @@
+/*
+ * grid_graph.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef GRID_GRAPH_HPP_
+#define GRID_GRAPH_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace elib{
+
+/*
+ * Boykov-Kolmogorov max-flow specialised to regular 2D/3D grids.
+ *
+ * Nodes are addressed by their linear pixel index (x + y*width + z*width*height)
+ * and arcs by (node, direction), where the directions are the offsets of the
+ * neighbourhood passed to the constructor (triples dx,dy,dz as used by graphcut).
+ * Missing opposite offsets are appended, so direction l/3 of the given
+ * neighbourhood keeps its index. All capacities live in one flat array with one
+ * slot per node and direction; there are no node or arc pointers.
+ */
+class GridGraph
+{
+	public:
+		typedef float captype;
+		typedef double flowtype;
+		typedef enum
+		{
+			SOURCE	= 0,
+			SINK	= 1
+		} termtype;
+
+		GridGraph(int width, int height, int depth, const int *neighbourhood, int neighbourhood_length);
+		virtual ~GridGraph();
+
+		/* Adds the edges 'SOURCE->node' and 'node->SINK', can be called multiple times per node */
+		void addTWeights(int node, captype cap_source, captype cap_sink);
+		/* Adds the edge from 'node' to its neighbour in 'direction' and the reverse edge */
+		void addEdge(int node, int direction, captype cap, captype rev_cap);
+		/*
+		 * Changes of the capacities after maxflow which keep the current flow (Kohli and Torr, dynamic graph cuts),
+		 * a following maxflow only has to push the difference. The value returned by maxflow is meaningless afterwards.
+		 */
+		void updateTWeights(int node, captype delta_source, captype delta_sink);
+		/* sets both capacities of the symmetric edge between 'node' and its neighbour in 'direction' to 'cap' */
+		void setEdge(int node, int direction, captype cap);
+		flowtype maxflow();
+		/* Solves slabs of planes concurrently and merges neighbouring slabs until one region is left */
+		flowtype parallelMaxflow(int num_threads);
+		termtype whatSegment(int node) const;
+
+		int getNeighbour(int node, int direction) const;
+		int getNumberOfDirections() const
+		{
+			return num_directions;
+		}
+		int getOppositeDirection(int direction) const
+		{
+			return opposite[direction];
+		}
+		int getNumberOfNodes() const
+		{
+			return num_nodes;
+		}
+		static std::size_t bytesPerNode(int num_directions);
+
+	private:
+		const static signed char FREE = -1;
+		const static signed char TERMINAL = -2;
+		const static signed char ORPHAN = -3;
+		const static int NONE = -1;
+		const static int INFINITE_D = 1000000000;
+
+		int width,
+			height,
+			depth,
+			num_nodes,
+			num_directions;
+		std::vector<int> dx, dy, dz, delta, opposite;
+		unsigned int class_masks[64];
+
+		std::vector<captype> r_cap;			/* residual capacity of arc (node, direction) at node*num_directions+direction */
+		std::vector<captype> tr_cap;		/* > 0 residual capacity of SOURCE->node, < 0 of node->SINK */
+		std::vector<signed char> parent;	/* direction of the arc to the parent, or FREE, TERMINAL, ORPHAN */
+		std::vector<unsigned char> is_sink;
+		std::vector<int> next, TS, DIST;
+
+		flowtype flow = 0;
+
+		/*
+		 * Search state of one maxflow run on the planes [plane_begin, plane_end), planes being z-slices of
+		 * a volume or rows of an image. Arcs leaving the region are ignored, so disjoint regions can be
+		 * processed concurrently.
+		 */
+		struct Region
+		{
+			int plane_begin, plane_end;
+			int queue_first[2], queue_last[2];
+			std::deque<int> orphans;
+			int TIME;
+			flowtype flow;
+		};
+
+		inline std::size_t arc(int node, int direction) const
+		{
+			return std::size_t(node)*num_directions + direction;
+		}
+		inline std::size_t sister(int node, int direction) const
+		{
+			return arc(node + delta[direction], opposite[direction]);
+		}
+		inline unsigned int validDirections(int node) const
+		{
+			int x = node % width,
+				y = (node / width) % height,
+				z = node / (width*height);
+			return class_masks[axisClass(x, width) + 4*axisClass(y, height) + 16*axisClass(z, depth)];
+		}
+		inline unsigned int validDirections(int node, const Region &r) const
+		{
+			int x = node % width,
+				y = (node / width) % height,
+				z = node / (width*height);
+			if(depth > 1)
+				return class_masks[axisClass(x, width) + 4*axisClass(y, height) + 16*axisClass(z-r.plane_begin, r.plane_end-r.plane_begin)];
+			else
+				return class_masks[axisClass(x, width) + 4*axisClass(y-r.plane_begin, r.plane_end-r.plane_begin) + 16*3];
+		}
+		inline int planeSize() const
+		{
+			return depth > 1 ? width*height : width;
+		}
+		inline int numberOfPlanes() const
+		{
+			return depth > 1 ? depth : height;
+		}
+		static inline int axisClass(int position, int length)
+		{
+			return (position == 0 ? 1 : 0) | (position == length-1 ? 2 : 0);
+		}
+
+		void setActive(Region &r, int i);
+		int nextActive(Region &r);
+		void maxflowInit(Region &r);
+		void augment(Region &r, int middle_node, int middle_direction);
+		void processSourceOrphan(Region &r, int i);
+		void processSinkOrphan(Region &r, int i);
+		void maxflow(Region &r);
+};
+
+} /* end namespace elib */
+
+#endif /* GRID_GRAPH_HPP_ */
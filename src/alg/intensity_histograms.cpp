@@ -0,0 +1,108 @@
+/*
+ * intensity_histograms.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "intensity_histograms.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utilities/parallel.hpp"
+#include "utilities/profile.hpp"
+
+namespace elib{
+
+namespace
+{
+
+/* convolution with a Gaussian truncated at 3 standard deviations, the histogram is cut off at its ends */
+std::vector<double> smooth(const std::vector<double> &counts, double sigma)
+{
+	int reach = int(ceil(3*sigma)),
+		length = int(counts.size());
+	std::vector<double> kernel(2*reach+1), smoothed(counts.size(), 0.);
+	for(int k=-reach; k<=reach; ++k)
+	{
+		kernel[k+reach] = exp(-0.5*k*k/(sigma*sigma));
+	}
+	for(int i=0; i<length; ++i)
+	{
+		if(counts[i] == 0)
+			continue;
+		for(int k=std::max(-reach, -i); k<=std::min(reach, length-1-i); ++k)
+		{
+			smoothed[i+k] += counts[i]*kernel[k+reach];
+		}
+	}
+	return smoothed;
+}
+
+void normalize(const std::vector<double> &counts, std::vector<float> &histogram)
+{
+	double total = 0;
+	for(double count : counts)
+	{
+		total += count;
+	}
+	histogram.assign(counts.size(), 0.f);
+	if(total > 0)
+	{
+		for(std::size_t i=0; i<counts.size(); ++i)
+		{
+			histogram[i] = float(counts[i]/total);
+		}
+	}
+}
+
+} /* end anonymous namespace */
+
+void intensityHistograms(const Image<int> &label_image, const Image<int> &input_image, int num_intensities,
+		std::vector<float> &background, std::vector<float> &foreground, double smoothing, int num_threads)
+{
+	ScopedTimer timer("intensity histograms");
+	const int *labels = label_image.getData(),
+		*intensities = input_image.getData();
+	int width = input_image.getWidth(),
+		rows = input_image.getHeight()*input_image.getDepth();
+	if(num_threads <= 0)
+		num_threads = defaultNumberOfThreads();
+	int num_chunks = std::max(1, std::min(num_threads, rows));
+
+	// counts of the background followed by the foreground per chunk of rows
+	std::vector<std::vector<long long>> chunk_counts(num_chunks);
+	parallelFor(0, num_chunks, [&](int chunk)
+	{
+		std::vector<long long> &counts = chunk_counts[chunk];
+		counts.assign(2*std::size_t(num_intensities), 0);
+		std::size_t begin = std::size_t(rows)*chunk/num_chunks*width,
+			end = std::size_t(rows)*(chunk+1)/num_chunks*width;
+		for(std::size_t i=begin; i<end; ++i)
+		{
+			int intensity = intensities[i];
+			if(intensity >= 0 && intensity < num_intensities)
+				++counts[intensity + (labels[i] != 0 ? num_intensities : 0)];
+		}
+	}, num_threads);
+
+	std::vector<double> background_counts(num_intensities, 0.), foreground_counts(num_intensities, 0.);
+	for(auto &counts : chunk_counts)
+	{
+		for(int i=0; i<num_intensities; ++i)
+		{
+			background_counts[i] += counts[i];
+			foreground_counts[i] += counts[i+num_intensities];
+		}
+	}
+	if(smoothing > 0)
+	{
+		background_counts = smooth(background_counts, smoothing);
+		foreground_counts = smooth(foreground_counts, smoothing);
+	}
+	normalize(background_counts, background);
+	normalize(foreground_counts, foreground);
+}
+
+} /* end namespace elib */
@@ -0,0 +1,29 @@
+/*
+ * intensity_histograms.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef INTENSITY_HISTOGRAMS_HPP_
+#define INTENSITY_HISTOGRAMS_HPP_
+
+#include <vector>
+
+#include "templates/image.hpp"
+
+namespace elib{
+
+/*
+ * Relative frequencies of the intensities of input_image on the background (label 0) and on the foreground
+ * (all other labels) of label_image, for intensities in [0, num_intensities); others are not counted. Both
+ * images are streamed once, with rows counted concurrently (num_threads, 0 = all hardware threads) into
+ * histograms per thread that are summed. A positive smoothing convolves the counts with a Gaussian of this
+ * standard deviation in intensity levels. A histogram without pixels stays 0.
+ */
+void intensityHistograms(const Image<int> &label_image, const Image<int> &input_image, int num_intensities,
+		std::vector<float> &background, std::vector<float> &foreground, double smoothing = 0, int num_threads = 0);
+
+} /* end namespace elib */
+
+#endif /* INTENSITY_HISTOGRAMS_HPP_ */
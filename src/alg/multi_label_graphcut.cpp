@@ -8,212 +8,449 @@
 #include "multi_label_graphcut.hpp"
 
 #include <math.h>
-#include <unordered_map>
-#include <set>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 #include <iostream>
 
-#include "alg/components_measurements.hpp"
+#include "alg/intensity_histograms.hpp"
 #include "gco/GCoptimization.h"
-#include "glm/glm.hpp"
 #include "utilities/math_functions.hpp"
-#include "templates/mask.hpp"
-#include "templates/mask_list.hpp"
-
-
-#define GC_INFINITY 300000.
+#include "utilities/parallel.hpp"
+#include "utilities/profile.hpp"
 
 using elib::MultiLabelGraphcut;
 using elib::Image;
 
-std::shared_ptr<Image<int>> MultiLabelGraphcut::multilabel_graphcut(Image<int> &label_image, Image<int> &input_image, Parameters &input_params)
+namespace
 {
-	int width, height, bit_depth, num_labels;
-    std::set<int> labels;
-	std::set<int>::iterator it;
-	std::unordered_map<int,int> label_map;
-	int label, num_pixels;
-	std::shared_ptr<Image<int>> new_label_image = std::shared_ptr<Image<int>>(new Image<int>(label_image.getRank(), *label_image.getDimensions(), label_image.getBitDepth(), label_image.getChannels()));
 
-	float 	c0, c1, lambda, sigma, mu;
-	if(
-		isnan(num_labels = input_params.getIntegerParameter("NumberLabels")) ||
-		isnan(c0 = input_params.getDoubleParameter("C0")) ||
-		isnan(c1 = input_params.getDoubleParameter("C1")) ||
-		isnan(lambda = input_params.getDoubleParameter("Lambda")) ||
-		isnan(sigma = input_params.getDoubleParameter("Sigma")) ||
-		isnan(mu = input_params.getDoubleParameter("Mu"))
-	)
+/*
+ * Pixels the labels may take in the localized mode: the previous mask of every label index > 1 dilated by a
+ * square (cube) of the given radius, the labels allowed on every pixel, and the pairs of labels whose regions
+ * overlap.
+ */
+struct LabelRegions
+{
+	std::vector<std::vector<int>> sites;	/* ascending pixels per label index */
+	std::vector<int> offsets, labels;	/* ascending labels allowed on pixel s in labels[offsets[s]..offsets[s+1]) */
+	std::vector<std::pair<int,int>> pairs;	/* a < b, by a ascending and b descending */
+
+	/* dimensions are width, height and depth */
+	LabelRegions(const std::vector<int> &previous, const int dimensions[3], int num_labels, int radius, int num_threads)
+		: sites(num_labels), offsets(std::size_t(dimensions[0])*dimensions[1]*dimensions[2]+1, 0)
 	{
-		return nullptr;
+		int length = int(offsets.size())-1;
+		auto position = [&](int s, int d)
+		{
+			return d == 0 ? s%dimensions[0] : (d == 1 ? (s/dimensions[0])%dimensions[1] : s/(dimensions[0]*dimensions[1]));
+		};
+		// bounding boxes of the previous masks
+		std::vector<int> low(3*num_labels), high(3*num_labels, -1);
+		for(int l=0; l<num_labels; ++l)
+		{
+			std::copy(dimensions, dimensions+3, low.begin()+3*l);
+		}
+		for(int s=0; s<length; ++s)
+		{
+			int l = previous[s];
+			if(l > 1 && l < num_labels)
+			{
+				for(int d=0; d<3; ++d)
+				{
+					low[3*l+d] = std::min(low[3*l+d], position(s, d));
+					high[3*l+d] = std::max(high[3*l+d], position(s, d));
+				}
+			}
+		}
+		elib::parallelFor(2, std::max(2, num_labels), [&](int l)
+		{
+			if(high[3*l] < 0)
+				return;
+			int origin[3], size[3];
+			for(int d=0; d<3; ++d)
+			{
+				origin[d] = std::max(0, low[3*l+d]-radius);
+				size[d] = std::min(dimensions[d]-1, high[3*l+d]+radius) - origin[d] + 1;
+			}
+			auto global = [&](int i)
+			{
+				return origin[0] + i%size[0] + (origin[1] + (i/size[0])%size[1] + (origin[2] + i/(size[0]*size[1]))*dimensions[1])*dimensions[0];
+			};
+			std::vector<int> mask(std::size_t(size[0])*size[1]*size[2]),
+				sums(std::max(size[0], std::max(size[1], size[2]))+1);
+			for(std::size_t i=0; i<mask.size(); ++i)
+			{
+				mask[i] = previous[global(int(i))] == l;
+			}
+			// dilation by running sums along every axis of the enlarged bounding box
+			for(int d=0, stride=1; d<3; stride*=size[d++])
+			{
+				for(int line=0; line<int(mask.size())/size[d]; ++line)
+				{
+					int *begin = mask.data() + (line/stride)*stride*size[d] + line%stride;
+					for(int t=0; t<size[d]; ++t)
+					{
+						sums[t+1] = sums[t] + begin[t*stride];
+					}
+					for(int t=0; t<size[d]; ++t)
+					{
+						begin[t*stride] = sums[std::min(size[d], t+radius+1)] > sums[std::max(0, t-radius)];
+					}
+				}
+			}
+			for(std::size_t i=0; i<mask.size(); ++i)
+			{
+				if(mask[i])
+					sites[l].push_back(global(int(i)));
+			}
+		}, num_threads);
+		for(int l=2; l<num_labels; ++l)
+		{
+			for(int s : sites[l])
+			{
+				++offsets[s+1];
+			}
+		}
+		for(std::size_t s=1; s<offsets.size(); ++s)
+		{
+			offsets[s] += offsets[s-1];
+		}
+		labels.resize(offsets.back());
+		std::vector<int> next(offsets.begin(), offsets.end()-1),
+			last_pair(num_labels, -1);
+		for(int l=2; l<num_labels; ++l)
+		{
+			for(int s : sites[l])
+			{
+				labels[next[s]++] = l;
+			}
+		}
+		for(int a=2; a<num_labels; ++a)
+		{
+			for(int s : sites[a])
+			{
+				for(int i=offsets[s]; i<offsets[s+1]; ++i)
+				{
+					int b = labels[i];
+					if(b > a && last_pair[b] != a)
+					{
+						last_pair[b] = a;
+						pairs.emplace_back(a, b);
+					}
+				}
+			}
+		}
+		// the order of oneSwapIteration of GCO, b descending for every a
+		std::sort(pairs.begin(), pairs.end(), [](const std::pair<int,int> &p, const std::pair<int,int> &q)
+		{
+			return p.first != q.first ? p.first < q.first : p.second > q.second;
+		});
+	}
+
+	bool allows(int s, int l) const
+	{
+		return std::binary_search(labels.begin()+offsets[s], labels.begin()+offsets[s+1], l);
 	}
-	width = input_image.getWidth();
-	height = input_image.getHeight();
-	bit_depth = input_image.getBitDepth();
-	int *label_data = label_image.getData(),
-        *image_data = input_image.getData();
+};
 
-	labels.insert(label_image.getData(), label_image.getData()+label_image.getFlattenedLength());
-	labels.insert(1); //inserts label 1
-	int label_array[labels.size()];
-	std::copy(labels.begin(), labels.end(), label_array);
+/*
+ * Data costs of the multi label graph cut. They only depend on the intensity of a pixel and the index of its
+ * previous label: label 0 (background) costs the background term, all other labels the foreground term, plus
+ * mu if the label differs from the previous one, and label 1 (appearing objects) is forbidden on previous
+ * objects. The terms are looked up per intensity, so the costs are handed to GCO as a functor taking memory
+ * linear in the number of pixels instead of the pixels x labels array of setDataCost, which is also not
+ * faster to optimize. In the localized mode labels are forbidden outside their regions.
+ */
+class DataCosts : public GCoptimization::DataCostFunctor
+{
+	public:
+		DataCosts(const int *intensities, const int *previous, const std::vector<double> &background,
+				const std::vector<double> &foreground, double mu, const LabelRegions *regions = nullptr)
+			: intensities(intensities), previous(previous), background(background), foreground(foreground), mu(mu), regions(regions)
+		{
+		}
 
-	for(unsigned int i=0; i<labels.size(); ++i)
+		GCoptimization::EnergyTermType compute(GCoptimization::SiteID s, GCoptimization::LabelID l) override
+		{
+			if(l == 1)
+				return previous[s] != 0 ? elib::GC_INFINITY : foreground[intensities[s]];
+			if(l > 1 && regions != nullptr && !regions->allows(s, l))
+				return elib::GC_INFINITY;
+			return mu*elib::label_dist(l-previous[s]) + (l == 0 ? background[intensities[s]] : foreground[intensities[s]]);
+		}
+
+	private:
+		const int *intensities, *previous;
+		const std::vector<double> &background, &foreground;
+		double mu;
+		const LabelRegions *regions;
+};
+
+/*
+ * one alpha-beta swap cycle of the localized mode in the label order of GCO: background and appearing objects
+ * against every label inside its region and against each other on the whole image, then every pair of labels
+ * inside the overlap of their regions, which are the only pairs that can exchange pixels. Returns the energy.
+ */
+GCoptimization::EnergyType localizedSwapCycle(GCoptimization &gc, const LabelRegions &regions)
+{
+	std::vector<GCoptimization::SiteID> alpha_sites, beta_sites;
+	auto swap = [&](int alpha, int beta, const std::vector<int> &alpha_candidates, const std::vector<int> &beta_candidates)
+	{
+		alpha_sites.clear();
+		beta_sites.clear();
+		for(int s : alpha_candidates)
+		{
+			if(gc.whatLabel(s) == alpha)
+				alpha_sites.push_back(s);
+		}
+		for(int s : beta_candidates)
+		{
+			if(gc.whatLabel(s) == beta)
+				beta_sites.push_back(s);
+		}
+		if(!alpha_sites.empty() || !beta_sites.empty())
+			gc.alpha_beta_swap(alpha, beta, alpha_sites.data(), int(alpha_sites.size()), beta_sites.data(), int(beta_sites.size()));
+	};
+	for(int l=int(regions.sites.size())-1; l>1; --l)
 	{
-		label_map.insert(std::pair<int,int>(label_array[i],i));
+		swap(0, l, regions.sites[l], regions.sites[l]);
 	}
+	gc.alpha_beta_swap(0, 1);
+	for(int l=int(regions.sites.size())-1; l>1; --l)
+	{
+		swap(1, l, regions.sites[l], regions.sites[l]);
+	}
+	for(auto &pair : regions.pairs)
+	{
+		swap(pair.first, pair.second, regions.sites[pair.second], regions.sites[pair.first]);
+	}
+	return gc.compute_energy();
+}
 
-	try{
-		GCoptimizationGridGraph *gc = new GCoptimizationGridGraph(width,height, num_labels);
-		num_pixels = width*height;
-		// first set up data costs individually
+/*
+ * one alpha expansion cycle of the localized mode: background and appearing objects on the whole image and
+ * every label inside its region. Returns the energy.
+ */
+GCoptimization::EnergyType localizedExpansionCycle(GCoptimization &gc, const LabelRegions &regions)
+{
+	gc.alpha_expansion(0);
+	gc.alpha_expansion(1);
+	for(int l=2; l<int(regions.sites.size()); ++l)
+	{
+		if(!regions.sites[l].empty())
+			gc.alpha_expansion(l, regions.sites[l].data(), int(regions.sites[l].size()));
+	}
+	return gc.compute_energy();
+}
 
-		//background labeling == 0
-		float c=c0*(pow(2,bit_depth)-1);
-		float max_intensity = pow(2,bit_depth)-1;
-		for (int i = 0; i < num_pixels; i++ )
+/*
+ * sorted distinct labels of the image together with label 1, and the index of the label of every pixel
+ * among them, through a dense remap table unless the labels are spread too widely
+ */
+void denseLabels(Image<int> &label_image, std::vector<int> &labels, std::vector<int> &indices, int num_threads)
+{
+	const long long MAX_TABLE_SIZE = 1 << 24;
+	const int *label_data = label_image.getData();
+	int length = label_image.getFlattenedLength(),
+		min = *std::min_element(label_data, label_data+length),
+		max = *std::max_element(label_data, label_data+length);
+	min = std::min(min, 1);
+	max = std::max(max, 1);
+	indices.resize(length);
+	labels.clear();
+	if((long long)max-min < MAX_TABLE_SIZE)
+	{
+		std::vector<int> table(max-min+1, -1);
+		for(int i=0; i<length; ++i)
 		{
-			label = label_map.find(label_data[i])->second;
-			gc->setDataCost(i,0, mu*label_dist(label)+fabsf(float(image_data[i])-c)/max_intensity);
+			table[label_data[i]-min] = 0;
 		}
-		//label for appearing objects == 1
-		c=c1*(pow(2,bit_depth)-1);
-		for (int i = 0; i < num_pixels; i++ )
+		table[1-min] = 0;
+		for(int label=min; label<=max; ++label)
 		{
-			label = label_map.find(label_data[i])->second;
-			if(label_dist(label))
+			if(table[label-min] == 0)
 			{
-				gc->setDataCost(i,1, GC_INFINITY);
+				table[label-min] = int(labels.size());
+				labels.push_back(label);
 			}
-			else
+		}
+		elib::parallelFor(0, label_image.getHeight()*label_image.getDepth(), [&](int row)
+		{
+			for(int i=row*label_image.getWidth(); i<(row+1)*label_image.getWidth(); ++i)
 			{
-				gc->setDataCost(i,1, fabsf(float(image_data[i]-c)/max_intensity));
+				indices[i] = table[label_data[i]-min];
 			}
-		}
-		//other labels
-		for (int l = 2; l < num_labels; l++ )
+		}, num_threads);
+	}
+	else
+	{
+		labels.assign(label_data, label_data+length);
+		labels.push_back(1);
+		std::sort(labels.begin(), labels.end());
+		labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+		elib::parallelFor(0, label_image.getHeight()*label_image.getDepth(), [&](int row)
 		{
-			for (int i = 0; i < num_pixels; i++ )
+			for(int i=row*label_image.getWidth(); i<(row+1)*label_image.getWidth(); ++i)
 			{
-				label = label_map.find(label_data[i])->second;
-				gc->setDataCost(i,l, mu*label_dist(l-label)+fabsf(float(image_data[i]-c)/max_intensity));
+				indices[i] = int(std::lower_bound(labels.begin(), labels.end(), label_data[i]) - labels.begin());
 			}
-		}
+		}, num_threads);
+	}
+}
 
-//		 //next set up smoothness costs individually
-//				for ( int l1 = 0; l1 < numLabels; l1++ )
-//					for (int l2 = 0; l2 < numLabels; l2++ )
-//					{
-//						gc->setSmoothCost(l1,l2,l1==l2 ? 0 : lambda);
-//					}
-		ForSmoothFn data;
-		data.image = image_data;
-		data.lambda = lambda;
-		data.sigma = sigma;
-		data.mu = mu;
-		data.max_intensity = max_intensity;
-		gc->setSmoothCost(&smoothFn, &data);
-		gc->swap(cycles);
-		for (int i = 0; i < num_pixels; i++)
-		{
-			new_label_image->getData()[i] = label_array[gc->whatLabel(i)];
-		}
+} /* end anonymous namespace */
 
-		delete gc;
+std::shared_ptr<Image<int>> MultiLabelGraphcut::multilabel_graphcut(Image<int> &label_image, Image<int> &input_image, Parameters &input_params)
+{
+	int num_labels;
+	float 	c0, c1, lambda, sigma, mu;
+	if(
+		isnan(num_labels = input_params.getIntegerParameter("NumberLabels")) ||
+		isnan(c0 = input_params.getDoubleParameter("C0")) ||
+		isnan(c1 = input_params.getDoubleParameter("C1")) ||
+		isnan(lambda = input_params.getDoubleParameter("Lambda")) ||
+		isnan(sigma = input_params.getDoubleParameter("Sigma")) ||
+		isnan(mu = input_params.getDoubleParameter("Mu"))
+	)
+	{
+		return nullptr;
 	}
-	catch (GCException &e){
-		e.Report();
+	int bit_depth = input_image.getBitDepth(),
+		*image_data = input_image.getData();
+
+	//distance to the background and foreground intensity
+	float background_intensity = c0*(pow(2,bit_depth)-1),
+		foreground_intensity = c1*(pow(2,bit_depth)-1),
+		max_intensity = pow(2,bit_depth)-1;
+	int num_intensities = std::max(int(pow(2,bit_depth)), *std::max_element(image_data, image_data+input_image.getFlattenedLength())+1);
+	std::vector<double> background(num_intensities), foreground(num_intensities);
+	for(int i=0; i<num_intensities; ++i)
+	{
+		background[i] = fabsf(float(i)-background_intensity)/max_intensity;
+		foreground[i] = fabsf(float(i-foreground_intensity)/max_intensity);
 	}
-	return new_label_image;
+	return optimize(label_image, input_image, background, foreground, num_labels, lambda, sigma, mu, input_params);
 }
 
 std::shared_ptr<Image<int>> MultiLabelGraphcut::adaptive_multilabel_graphcut(Image<int> &label_image, Image<int> &input_image, Parameters &input_params)
 {
-	std::shared_ptr<Image<int>> new_label_image;
 	int num_labels;
-	double lambda, mu;
+	double lambda, sigma, mu;
 	if(
 		isnan(num_labels = input_params.getIntegerParameter("NumberLabels")) ||
 		isnan(lambda = input_params.getDoubleParameter("Lambda")) ||
+		isnan(sigma = input_params.getDoubleParameter("Sigma")) ||
 		isnan(mu = input_params.getDoubleParameter("Mu"))
 	)
 	{
 		return nullptr;
 	}
 
-	std::set<int> labels;
-	labels.insert(label_image.getData(), label_image.getData()+label_image.getFlattenedLength());
-	labels.insert(1); //inserts label 1
-	int label_array[labels.size()];
-	std::copy(labels.begin(), labels.end(), label_array);
-	std::unordered_map<int,int> label_map;
-	for(unsigned int i=0; i<labels.size(); ++i)
+	//one minus the frequency of an intensity in the background and the foreground
+	int num_intensities = std::max(int(pow(2,input_image.getBitDepth())),
+			*std::max_element(input_image.getData(), input_image.getData()+input_image.getFlattenedLength())+1);
+	std::vector<float> c0, c1;
+	intensityHistograms(label_image, input_image, num_intensities, c0, c1,
+			std::max(0., input_params.getDoubleParameter("HistogramSmoothing")), input_params.getIntegerParameter("Threads"));
+	std::vector<double> background(c0.size()), foreground(c1.size());
+	for(std::size_t i=0; i<c0.size(); ++i)
 	{
-		label_map.insert(std::pair<int,int>(label_array[i],i));
+		background[i] = 1.- c0[i];
+		foreground[i] = 1.- c1[i];
 	}
+	return optimize(label_image, input_image, background, foreground, num_labels, lambda, sigma, mu, input_params);
+}
 
-	std::vector<float> c0, c1;
-	calculateIntensityDistributions(c0, c1, label_image, input_image);
+std::shared_ptr<Image<int>> MultiLabelGraphcut::optimize(Image<int> &label_image, Image<int> &input_image, const std::vector<double> &background,
+		const std::vector<double> &foreground, int num_labels, float lambda, float sigma, double mu, Parameters &input_params)
+{
+	int num_threads = input_params.getIntegerParameter("Threads"),
+		label_radius = input_params.getIntegerParameter("LabelRadius"),
+		optimizer = input_params.getIntegerParameter("Optimizer"),
+		max_cycles = input_params.getIntegerParameter("MaxCycles"),
+		neighborhood = input_params.getIntegerParameter("Neighborhood");
+	double epsilon = input_params.getDoubleParameter("Epsilon"),
+		time_limit = input_params.getDoubleParameter("TimeLimit");
+	if(neighborhood == 0)
+		neighborhood = 6;
+	if(optimizer < static_cast<int>(optimizer_type::SWAP) || optimizer > static_cast<int>(optimizer_type::EXPANSION) ||
+			(neighborhood != 6 && neighborhood != 18 && neighborhood != 26))
+	{
+		return nullptr;
+	}
+	if(isnan(epsilon))
+		epsilon = 0;
+	trace.clear();
+	ScopedTimer setup_timer("multilabel setup");
+	std::vector<int> labels, previous;
+	denseLabels(label_image, labels, previous, num_threads);
 
 	int width = input_image.getWidth(),
-		height = input_image.getHeight();
+		height = input_image.getHeight(),
+		depth = input_image.getDepth(),
+		dimensions[3] = {width, height, depth},
+		bit_depth = input_image.getBitDepth(),
+		*image_data = input_image.getData();
+	std::shared_ptr<Image<int>> new_label_image;
 	try{
-		GCoptimizationGridGraph *gc = new GCoptimizationGridGraph(width,height, num_labels);
-		int label,
-			*label_data = label_image.getData(),
-			*image_data = input_image.getData(),
-			num_pixels = width*height;
-		// first set up data costs individually
-
-		//background labeling == 0
-		for (int i = 0; i < num_pixels; i++ )
-		{
-			label = label_map.find(label_data[i])->second;
-			gc->setDataCost(i,0, mu*label_dist(label) + (1.- c0[image_data[i]]));
-		}
-		//label for appearing objects == 1
-		for (int i = 0; i < num_pixels; i++ )
-		{
-			label = label_map.find(label_data[i])->second;
-			if(label_dist(label))
-			{
-				gc->setDataCost(i,1, GC_INFINITY);
-			}
-			else
-			{
-				gc->setDataCost(i,1,  1.- c1[image_data[i]]);
-			}
-		}
-		//other labels
-		for (int l = 2; l < num_labels; l++ )
-		{
-			for (int i = 0; i < num_pixels; i++ )
-			{
-				label = label_map.find(label_data[i])->second;
-				gc->setDataCost(i,l, mu*label_dist(l-label) + (1.- c1[image_data[i]]));
-			}
-		}
+		std::unique_ptr<GCoptimization> gc;
+		if(depth > 1)
+			gc.reset(new GCoptimizationGridGraph3D(width, height, depth, num_labels, neighborhood));
+		else
+			gc.reset(new GCoptimizationGridGraph(width,height, num_labels));
+		std::unique_ptr<LabelRegions> regions;
+		if(label_radius > 0)
+			regions.reset(new LabelRegions(previous, dimensions, num_labels, label_radius, num_threads));
+		ScopedAllocation regions_allocation(regions != nullptr ? (regions->offsets.size()+regions->labels.size())*sizeof(int) : 0);
+		DataCosts data_costs(image_data, previous.data(), background, foreground, mu, regions.get());
+		gc->setDataCostFunctor(&data_costs);
 
-//		 //next set up smoothness costs individually
-//				for ( int l1 = 0; l1 < numLabels; l1++ )
-//					for (int l2 = 0; l2 < numLabels; l2++ )
-//					{
-//						gc->setSmoothCost(l1,l2,l1==l2 ? 0 : lambda);
-//					}
+		PairwiseWeightTable<float> weights = PairwiseWeightTable<float>::contrastSensitive(bit_depth, 1, sigma);
 		ForSmoothFn data;
 		data.image = image_data;
 		data.lambda = lambda;
+		data.sigma = sigma;
 		data.mu = mu;
-		gc->setSmoothCost(&smoothFn, &data);
-		gc->swap(cycles);
+		data.max_intensity = pow(2,bit_depth)-1;
+		data.weights = &weights;
+		gc->setSmoothCostInline(data);
+		gc->setLabelOrder(input_params.getIntegerParameter("RandomLabelOrder") != 0);
+		setup_timer.stop();
 
-		new_label_image = std::shared_ptr<Image<int>>(new Image<int>(label_image.getRank(), *label_image.getDimensions(), label_image.getBitDepth(), 1));
-		for (int i = 0; i < num_pixels; i++)
+		// one cycle at a time, to trace the energy and to stop early
+		ScopedTimer optimization_timer("multilabel optimization");
+		auto start = std::chrono::steady_clock::now();
+		auto record = [&](int cycle, GCoptimization::EnergyType energy)
+		{
+			trace.push_back({cycle, double(energy), std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count()});
+		};
+		GCoptimization::EnergyType energy = gc->compute_energy(), old_energy;
+		record(0, energy);
+		for(int cycle=1; max_cycles <= 0 || cycle <= max_cycles; ++cycle)
 		{
-			new_label_image->getData()[i] = label_array[gc->whatLabel(i)];
+			old_energy = energy;
+			if(optimizer == static_cast<int>(optimizer_type::EXPANSION))
+				energy = regions != nullptr ? localizedExpansionCycle(*gc, *regions) : gc->expansion(1);
+			else
+				energy = regions != nullptr ? localizedSwapCycle(*gc, *regions) : gc->swap(1);
+			record(cycle, energy);
+			if(old_energy-energy <= epsilon || (time_limit > 0 && trace.back().milliseconds >= time_limit))
+				break;
 		}
+		optimization_timer.stop();
 
-		delete gc;
+		ScopedTimer labeling_timer("multilabel labeling");
+		new_label_image = std::shared_ptr<Image<int>>(new Image<int>(label_image.getRank(), *label_image.getDimensions(), label_image.getBitDepth(), 1));
+		int *new_label_data = new_label_image->getData();
+		elib::parallelFor(0, height*depth, [&](int y)
+		{
+			for(int i=y*width; i<(y+1)*width; ++i)
+			{
+				new_label_data[i] = labels[gc->whatLabel(i)];
+			}
+		}, num_threads);
 	}
 	catch (GCException &e){
 		e.Report();
@@ -221,64 +458,7 @@ std::shared_ptr<Image<int>> MultiLabelGraphcut::adaptive_multilabel_graphcut(Ima
 	return new_label_image;
 }
 
-
 float elib::smoothFn(int p1, int p2, int l1, int l2, void *data)
 {
-	ForSmoothFn fsf = *((ForSmoothFn*) data);
-	if(l1==l2)
-		return fsf.lambda*exp(-powf(float(fsf.image[p1]-fsf.image[p2])/fsf.max_intensity,2)/fsf.sigma);
-	else
-	{
-		if((l1==1 && l2>1) || (l1>1 && l2==1))
-		{
-			return GC_INFINITY;
-		}
-		if((l1==0 && l2>1) || (l1>1 && l2==0))
-		{
-			return fsf.lambda*(fsf.mu*label_dist(l1-l2) + exp(-powf(float(fsf.image[p1]-fsf.image[p2])/fsf.max_intensity,2)/fsf.sigma));
-		}
-		else
-		{
-			return fsf.lambda*(fsf.mu*label_dist(l1-l2) + exp(-powf(float(fsf.image[p1]-fsf.image[p2])/fsf.max_intensity,2)/fsf.sigma));
-//			return GC_INFINITY;
-		}
-	}
-}
-
-inline float elib::label_dist(int value)
-{
-	if(value==0)
-		return 0.;
-	else
-		return 1.;
-}
-
-void MultiLabelGraphcut::calculateIntensityDistributions(std::vector<float> &c0, std::vector<float> &c1, Image<int> &label_image, Image<int> &input_image)
-{
-	ComponentsMeasurements<glm::ivec3> cm(label_image);
-	MaskList<glm::ivec3> masks = cm.getMasks();
-	Mask<glm::ivec3> foreground_mask = masks.fuse(),
-					 background_mask = Mask<glm::ivec3>::negate(foreground_mask);
-
-	c0 = std::vector<float>(pow(2, input_image.getBitDepth()));
-	c1 = std::vector<float>(pow(2, input_image.getBitDepth()));
-
-	std::vector<int> tmp = input_image.pick(*background_mask.getPoints());
-	for(auto i : tmp)
-	{
-		c0[i] += 1.;
-	}
-	for(int i=0; i<c0.size(); ++i)
-	{
-		c0[i] /= tmp.size();
-	}
-	tmp = input_image.pick(*foreground_mask.getPoints());
-	for(auto i : tmp)
-	{
-		c1[i] += 1.;
-	}
-	for(int i=0; i<c1.size(); ++i)
-	{
-		c1[i] /= tmp.size();
-	}
+	return static_cast<const ForSmoothFn*>(data)->compute(p1, p2, l1, l2);
 }
@@ -8,9 +8,12 @@
 #ifndef LABELING_HPP_
 #define LABELING_HPP_
 
+#include <memory>
 #include <vector>
 
+#include "alg/graphcut.hpp"
 #include "templates/image.hpp"
+#include "templates/pairwise_weight_table.hpp"
 #include "utilities/parameters.hpp"
 
 namespace elib{
@@ -18,14 +21,43 @@ namespace elib{
 class MultiLabelGraphcut
 {
 	public:
+		/* integer parameter "Optimizer", the moves of a cycle: all label pairs or all labels */
+		enum class optimizer_type {SWAP, EXPANSION};
+		struct TraceEntry
+		{
+			int cycle;	/* 0 for the initial labeling */
+			double energy;
+			double milliseconds;	/* since the start of the optimization */
+		};
+
 		MultiLabelGraphcut(){}
 		~MultiLabelGraphcut(){}
 		std::shared_ptr<Image<int>> multilabel_graphcut(Image<int> &label_image, Image<int> &input_image, Parameters &input_params);
+		/*
+		 * data terms from the intensity histograms of the background and the foreground of label_image,
+		 * optionally smoothed with the standard deviation "HistogramSmoothing" in intensity levels (0)
+		 */
 		std::shared_ptr<Image<int>> adaptive_multilabel_graphcut(Image<int> &label_image, Image<int> &input_image, Parameters &input_params);
+		/* energy after every cycle of the last cut */
+		const std::vector<TraceEntry>& getTrace() const { return trace; }
 
 	private:
-		int cycles = -1;
-		void calculateIntensityDistributions(std::vector<float> &c0, std::vector<float> &c1, Image<int> &label_image, Image<int> &input_image);
+		std::vector<TraceEntry> trace;
+		/*
+		 * shared by both cuts, with the data terms of the background and the foreground labels per intensity.
+		 * Optional parameters:
+		 * "Threads" (0 = all hardware threads) to remap the labels,
+		 * "LabelRadius": if positive, every label may only take pixels within this many pixels (maximum norm)
+		 * of its previous mask, it is only expanded inside this region and swapped with the labels whose regions
+		 * overlap, otherwise all labels are allowed everywhere,
+		 * "Optimizer" (SWAP), "RandomLabelOrder" (0) to visit the labels in a new random order every cycle,
+		 * which does not apply to the localized mode,
+		 * "MaxCycles" (0 = unlimited), "Epsilon" (0), to stop once a cycle decreases the energy by no more,
+		 * "TimeLimit" in milliseconds (0 = unlimited), checked after every cycle, and "Neighborhood" (6, 18
+		 * or 26) of the voxels of volumes, which are cut as a whole
+		 */
+		std::shared_ptr<Image<int>> optimize(Image<int> &label_image, Image<int> &input_image, const std::vector<double> &background,
+				const std::vector<double> &foreground, int num_labels, float lambda, float sigma, double mu, Parameters &input_params);
 };
 
 struct ForSmoothFn
@@ -36,11 +68,49 @@ struct ForSmoothFn
 		float mu;
 		float max_intensity;
 		int dummyLabel;
+		const PairwiseWeightTable<float> *weights; /* exp(-(d/max_intensity)^2/sigma) */
+
+		/*
+		 * contrast sensitive Potts costs, infinite between appearing objects and tracked labels; a functor
+		 * for GCoptimization::setSmoothCostInline, so the moves are compiled with it inlined
+		 */
+		float compute(int p1, int p2, int l1, int l2) const;
 };
 
-inline float label_dist(int value);
+inline float label_dist(int value)
+{
+	if(value==0)
+		return 0.;
+	else
+		return 1.;
+}
+
+/* ForSmoothFn::compute as a callback, data points to a ForSmoothFn */
 float smoothFn(int p1, int p2, int l1, int l2, void *data);
 
+inline float ForSmoothFn::compute(int p1, int p2, int l1, int l2) const
+{
+	float weight = (*weights)(image[p1], image[p2]);
+	if(l1==l2)
+		return lambda*weight;
+	else
+	{
+		if((l1==1 && l2>1) || (l1>1 && l2==1))
+		{
+			return GC_INFINITY;
+		}
+		if((l1==0 && l2>1) || (l1>1 && l2==0))
+		{
+			return lambda*(mu*label_dist(l1-l2) + weight);
+		}
+		else
+		{
+			return lambda*(mu*label_dist(l1-l2) + weight);
+//			return GC_INFINITY;
+		}
+	}
+}
+
 } /* namespace elib */
 
 #endif /* LABELING_HPP_ */
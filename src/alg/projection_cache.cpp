@@ -0,0 +1,114 @@
+/*
+ * projection_cache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "projection_cache.hpp"
+
+namespace elib{
+
+bool ProjectionCache::Key::operator==(const Key &other) const
+{
+	return type == other.type && width == other.width && height == other.height &&
+			radius == other.radius && lateral_projection_range == other.lateral_projection_range &&
+			standard_parallel == other.standard_parallel && central_meridian == other.central_meridian;
+}
+
+std::size_t ProjectionCache::Grid::getBytes() const
+{
+	return coordinates.size()*sizeof(glm::vec3) + inside.size()*sizeof(unsigned char);
+}
+
+ProjectionCache::ProjectionCache() : capacity(std::size_t(256) << 20)
+{
+}
+
+ProjectionCache& ProjectionCache::getInstance()
+{
+	static ProjectionCache cache;
+	return cache;
+}
+
+std::shared_ptr<const ProjectionCache::Grid> ProjectionCache::get(const Key &key, const std::function<void(Grid&)> &compute)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto it=grids.begin(); it!=grids.end(); ++it)
+	{
+		if(it->first == key)
+		{
+			++hits;
+			grids.splice(grids.begin(), grids, it);
+			return it->second;
+		}
+	}
+	++misses;
+	// computed under the lock, so concurrent calls with the same key compute the grid only once
+	std::shared_ptr<Grid> grid = std::make_shared<Grid>();
+	compute(*grid);
+	if(grid->getBytes() <= capacity)
+	{
+		grids.emplace_front(key, grid);
+		size += grid->getBytes();
+		evict();
+	}
+	return grid;
+}
+
+void ProjectionCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	grids.clear();
+	size = 0;
+	hits = 0;
+	misses = 0;
+}
+
+void ProjectionCache::setCapacity(std::size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->capacity = capacity;
+	evict();
+}
+
+std::size_t ProjectionCache::getCapacity() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return capacity;
+}
+
+std::size_t ProjectionCache::getSize() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return size;
+}
+
+int ProjectionCache::getNumberOfGrids() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return int(grids.size());
+}
+
+long long ProjectionCache::getHits() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return hits;
+}
+
+long long ProjectionCache::getMisses() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return misses;
+}
+
+void ProjectionCache::evict()
+{
+	while(size > capacity && !grids.empty())
+	{
+		size -= grids.back().second->getBytes();
+		grids.pop_back();
+	}
+}
+
+} /* end namespace elib */
@@ -0,0 +1,77 @@
+/*
+ * projection_cache.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef PROJECTION_CACHE_HPP_
+#define PROJECTION_CACHE_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace elib{
+
+/*
+ * Process wide least recently used cache of the sphere coordinates of the output pixels of a density
+ * projection, which only depend on the projection parameters and are the same for every frame of a
+ * time series. Grids are shared, so evicting one does not invalidate it for a running computation.
+ * The cache is bounded by the total size of the grids, a grid larger than the capacity is not kept.
+ */
+class ProjectionCache
+{
+	public:
+		struct Key
+		{
+			int type;
+			int width, height;
+			double radius, lateral_projection_range, standard_parallel, central_meridian;
+
+			bool operator==(const Key &other) const;
+		};
+		struct Grid
+		{
+			std::vector<glm::vec3> coordinates;	/* longitude in [0,2Pi], colatitude in [0,Pi] and radius per pixel */
+			std::vector<unsigned char> inside;	/* 0 for pixels outside the projected sphere */
+
+			std::size_t getBytes() const;
+		};
+
+		static ProjectionCache& getInstance();
+
+		/* the grid of key, filled by compute on a miss */
+		std::shared_ptr<const Grid> get(const Key &key, const std::function<void(Grid&)> &compute);
+		/* removes all grids and resets the counters */
+		void clear();
+		/* in bytes, 0 disables caching */
+		void setCapacity(std::size_t capacity);
+		std::size_t getCapacity() const;
+		std::size_t getSize() const;
+		int getNumberOfGrids() const;
+		long long getHits() const;
+		long long getMisses() const;
+
+	private:
+		ProjectionCache();
+		ProjectionCache(const ProjectionCache&) = delete;
+		ProjectionCache& operator=(const ProjectionCache&) = delete;
+
+		void evict();
+
+		/* most recently used first */
+		std::list<std::pair<Key, std::shared_ptr<const Grid>>> grids;
+		std::size_t capacity, size = 0;
+		long long hits = 0, misses = 0;
+		mutable std::mutex mutex;
+};
+
+} /* end namespace elib */
+
+#endif /* PROJECTION_CACHE_HPP_ */
@@ -0,0 +1,119 @@
+/*
+ * tiled_graphcut.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "tiled_graphcut.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <memory>
+
+#include "alg/graphcut.hpp"
+#include "utilities/math_functions.hpp"
+
+namespace elib{
+
+int tiledGraphcut(VolumeReader &reader, VolumeWriter &writer, Parameters &parameters)
+{
+	double c0, c1, lambda, sigma, memory_limit;
+	int bit_depth = parameters.getIntegerParameter("BitDepth"),
+		halo = parameters.getIntegerParameter("Halo");
+	if(
+		elib::isnan(c0 = parameters.getDoubleParameter("C0")) ||
+		elib::isnan(c1 = parameters.getDoubleParameter("C1")) ||
+		elib::isnan(lambda = parameters.getDoubleParameter("Lambda")) ||
+		elib::isnan(sigma = parameters.getDoubleParameter("Sigma")) ||
+		elib::isnan(memory_limit = parameters.getDoubleParameter("MemoryLimit")) ||
+		memory_limit <= 0 ||
+		halo < 0 ||
+		bit_depth <= 0
+	)
+	{
+		return -1;
+	}
+	Parameters tile_parameters;
+	tile_parameters.addParameter("C0", c0);
+	tile_parameters.addParameter("C1", c1);
+	tile_parameters.addParameter("Lambda", lambda);
+	tile_parameters.addParameter("Sigma", sigma);
+	graphcut_solver solver = static_cast<graphcut_solver>(parameters.getIntegerParameter("Solver"));
+	tile_parameters.addParameter("Solver", int(solver == graphcut_solver::GENERIC ? graphcut_solver::GRID : solver));
+	tile_parameters.addParameter("Threads", parameters.getIntegerParameter("Threads"));
+
+	const std::vector<int> &dimensions = reader.getDimensions();
+	int rank = dimensions.size();
+	double bytes_per_voxel = graphcutBytesPerVoxel(rank) + sizeof(unsigned char),
+		budget = memory_limit*1024.*1024.;
+
+	/****** Choose the core size *************************/
+	std::vector<int> core(dimensions), tile_size(rank);
+	while(true)
+	{
+		double voxels = 1;
+		for(int i=0; i<rank; ++i)
+		{
+			tile_size[i] = std::min(core[i] + 2*halo, dimensions[i]);
+			voxels *= tile_size[i];
+		}
+		if(voxels*bytes_per_voxel <= budget && voxels <= INT_MAX)
+			break;
+		int longest = std::max_element(core.begin(), core.end()) - core.begin();
+		if(core[longest] == 1)
+			return -1;
+		core[longest] = (core[longest]+1)/2;
+	}
+
+	/****** Cut tile by tile *************************/
+	std::vector<int> number_of_tiles(3, 1), core_offset(rank), core_size(rank), tile_offset(rank);
+	for(int i=0; i<rank; ++i)
+	{
+		number_of_tiles[i] = (dimensions[i] + core[i] - 1)/core[i];
+	}
+	std::vector<unsigned char> result;
+	int tiles = 0;
+	for(int tz=0; tz<number_of_tiles[2]; ++tz)
+	{
+		for(int ty=0; ty<number_of_tiles[1]; ++ty)
+		{
+			for(int tx=0; tx<number_of_tiles[0]; ++tx, ++tiles)
+			{
+				int index[3] = {tx, ty, tz};
+				for(int i=0; i<rank; ++i)
+				{
+					core_offset[i] = index[i]*core[i];
+					core_size[i] = std::min(core[i], dimensions[i] - core_offset[i]);
+					tile_offset[i] = std::max(0, core_offset[i] - halo);
+					tile_size[i] = std::min(dimensions[i], core_offset[i] + core_size[i] + halo) - tile_offset[i];
+				}
+				Image<int> tile(rank, tile_size, bit_depth, 1);
+				reader.read(tile_offset, tile_size, tile.getData());
+				std::unique_ptr<Image<short>> cut(graphcut(tile, tile_parameters));
+				if(cut == nullptr)
+					return -1;
+
+				// copy the core out of the tile
+				int depth = rank > 2 ? core_size[2] : 1;
+				result.resize(std::size_t(core_size[0])*core_size[1]*depth);
+				std::size_t position = 0;
+				for(int z=0; z<depth; ++z)
+				{
+					for(int y=0; y<core_size[1]; ++y)
+					{
+						int tz_offset = rank > 2 ? core_offset[2]-tile_offset[2]+z : 0;
+						const short *row = cut->getData() +
+								(std::size_t(tz_offset)*tile_size[1] + core_offset[1]-tile_offset[1]+y)*tile_size[0] + core_offset[0]-tile_offset[0];
+						std::copy(row, row+core_size[0], result.begin()+position);
+						position += core_size[0];
+					}
+				}
+				writer.write(core_offset, core_size, result.data());
+			}
+		}
+	}
+	return tiles;
+}
+
+} /* end namespace elib */
@@ -0,0 +1,33 @@
+/*
+ * tiled_graphcut.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef TILED_GRAPHCUT_HPP_
+#define TILED_GRAPHCUT_HPP_
+
+#include "io/volume_io.hpp"
+#include "utilities/parameters.hpp"
+
+namespace elib{
+
+/*
+ * Out-of-core variant of graphcut(Image<int>&, Parameters&) for volumes larger than main memory.
+ *
+ * The volume is split into non-overlapping core boxes, each cut is computed on the core grown by
+ * "Halo" voxels on every side and only the core is written, tile by tile in scan order, so the
+ * result does not depend on scheduling. Cores are halved along their longest axis until one tile
+ * (input, result and maxflow graph) fits into "MemoryLimit" megabytes. Next to the parameters
+ * of graphcut "BitDepth" is required; "Solver" and "Threads" are passed on, the GENERIC solver is
+ * replaced by GRID since only its memory use is bounded.
+ *
+ * Returns the number of tiles, or -1 if a parameter is missing, "Halo" is negative, "MemoryLimit" is not
+ * positive or too small for a tile of one voxel per axis.
+ */
+int tiledGraphcut(VolumeReader &reader, VolumeWriter &writer, Parameters &parameters);
+
+} /* end namespace elib */
+
+#endif /* TILED_GRAPHCUT_HPP_ */
@@ -12,6 +12,7 @@
 #include <sstream>
 
 #include "io/hdf5_wrapper.hpp"
+#include "utilities/profile.hpp"
 
 namespace elib
 {
@@ -220,6 +221,8 @@ void HDF5Reader::readIntegerData(MLINK loop, std::string dataset_name, const H5D
 {
 	try
 	{
+		// reading includes the decompression of the chunks and the transfer to the kernel
+		ScopedTimer timer("hdf5 read");
 		H5S dataspace(dataset);
 		/* Get the number of dimensions in this dataset */
 		int rank = dataspace.getSimpleExtentNDims();
@@ -244,6 +247,8 @@ void HDF5Reader::readIntegerData(MLINK loop, std::string dataset_name, const H5D
 		H5T datatype(dataset);
 		/* get size of integer in bytes */
 		size_t size = datatype.getSize();
+		Profile::getInstance().addBytes("hdf5 read", number_elements*size);
+		ScopedAllocation buffer(number_elements*size);
 
 		if(size == 1 || size == 2)
 		{
@@ -297,6 +302,7 @@ void HDF5Reader::readFloatData(MLINK loop, std::string dataset_name, const H5D &
 {
 	try
 	{
+		ScopedTimer timer("hdf5 read");
 		H5S dataspace(dataset);
 		/* Get the number of dimensions in this dataset */
 		int rank = dataspace.getSimpleExtentNDims();
@@ -321,6 +327,8 @@ void HDF5Reader::readFloatData(MLINK loop, std::string dataset_name, const H5D &
 		H5T datatype(dataset);
 		/* get size of integer in bytes */
 		size_t size = datatype.getSize();
+		Profile::getInstance().addBytes("hdf5 read", number_elements*size);
+		ScopedAllocation buffer(number_elements*size);
 
 		if(size == 4)
 		{
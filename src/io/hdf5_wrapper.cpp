@@ -44,6 +44,28 @@ H5F::H5F(const std::string& filename)
   }
 }
 
+H5F::H5F(const std::string& filename, bool writable)
+{
+  if( !writable )
+  {
+    id = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  }
+  else
+  {
+    H5E_BEGIN_TRY
+    {
+      id = H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+    if( id<0 )
+      id = H5Fcreate(filename.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+  }
+  if( id<0 )
+  {
+    throw H5Exception("Could not open '" + filename + "'!");
+  }
+}
+
 H5F::~H5F()
 {
   if( H5Fclose(id) < 0 )
@@ -62,6 +84,15 @@ H5D::H5D(const H5F& file, const std::string& dataset)
   }
 }
 
+H5D::H5D(const H5F& file, const std::string& dataset, hid_t type, const H5S& space)
+{
+  id = H5Dcreate2(file.getId(), dataset.c_str(), type, space.getId(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if( id<0 )
+  {
+    throw H5Exception("Could not create the dataset '" + dataset + "'!");
+  }
+}
+
 H5D::~H5D()
 {
   if( H5Dclose(id) < 0 )
@@ -113,6 +144,13 @@ H5S::H5S(const H5D& ds)
     throw H5Exception("H5Dget_space failed");
 }
 
+H5S::H5S(int rank, const hsize_t *dims)
+{
+  id = H5Screate_simple(rank, dims, NULL);
+  if( id<0 )
+    throw H5Exception("H5Screate_simple failed");
+}
+
 H5S::~H5S()
 {
   if( H5Sclose(id) < 0 )
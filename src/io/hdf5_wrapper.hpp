@@ -36,6 +36,8 @@ private:
   std::string message;
 };
 
+class H5S;
+
 class H5Base
 {
 public:
@@ -50,6 +52,8 @@ class H5F : public H5Base
 {
 public:
   H5F(const std::string& filename);
+  /* opens the file for writing if 'writable', creating it if it does not exist */
+  H5F(const std::string& filename, bool writable);
   ~H5F();
 };
 
@@ -57,6 +61,7 @@ class H5D : public H5Base
 {
 public:
   H5D(const H5F& file, const std::string& dataset);
+  H5D(const H5F& file, const std::string& dataset, hid_t type, const H5S& space);
   ~H5D();
 
   int getNumAttrs() const;
@@ -83,6 +88,7 @@ class H5S : public H5Base
 public:
   H5S(const H5A& dataset);
   H5S(const H5D& dataset);
+  H5S(int rank, const hsize_t *dims);
   ~H5S();
 
   int getSimpleExtentDims(hsize_t *dims) const;
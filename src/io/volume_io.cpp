@@ -0,0 +1,174 @@
+/*
+ * volume_io.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "volume_io.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace elib
+{
+
+namespace
+{
+
+/* {width, height[, depth]} -> HDF5 order {[depth,] height, width} */
+std::vector<hsize_t> hdf5Dimensions(const std::vector<int> &dimensions)
+{
+	return std::vector<hsize_t>(dimensions.rbegin(), dimensions.rend());
+}
+
+/* visits the rows of a box, calls function(y, z, position of the row within the box) */
+template <typename Function>
+void forEachRow(const std::vector<int> &offset, const std::vector<int> &size, Function function)
+{
+	int depth = size.size() > 2 ? size[2] : 1,
+		z_offset = offset.size() > 2 ? offset[2] : 0;
+	std::size_t row = 0;
+	for(int z=0; z<depth; ++z)
+	{
+		for(int y=0; y<size[1]; ++y, ++row)
+		{
+			function(offset[1]+y, z_offset+z, row*size[0]);
+		}
+	}
+}
+
+void selectBox(const H5S &file_space, const std::vector<int> &offset, const std::vector<int> &size)
+{
+	std::vector<hsize_t> start = hdf5Dimensions(offset),
+			count = hdf5Dimensions(size);
+	if(H5Sselect_hyperslab(file_space.getId(), H5S_SELECT_SET, start.data(), NULL, count.data(), NULL) < 0)
+	{
+		throw H5Exception("H5Sselect_hyperslab failed");
+	}
+}
+
+} /* end anonymous namespace */
+
+RawVolumeReader::RawVolumeReader(std::string file_name, const std::vector<int> &dimensions, int bit_depth)
+: file(file_name, std::ios::in | std::ios::binary)
+{
+	if(!file)
+	{
+		throw std::runtime_error("Could not open '" + file_name + "'!");
+	}
+	this->dimensions = dimensions;
+	bytes_per_voxel = bit_depth <= 8 ? 1 : (bit_depth <= 16 ? 2 : 4);
+}
+
+void RawVolumeReader::read(const std::vector<int> &offset, const std::vector<int> &size, int *data)
+{
+	std::vector<char> buffer(std::size_t(size[0])*bytes_per_voxel);
+	forEachRow(offset, size, [&](int y, int z, std::size_t position)
+	{
+		std::size_t voxel = (std::size_t(z)*dimensions[1] + y)*dimensions[0] + offset[0];
+		file.seekg(voxel*bytes_per_voxel);
+		if(!file.read(buffer.data(), buffer.size()))
+		{
+			throw std::runtime_error("Reading raw volume failed.");
+		}
+		for(int x=0; x<size[0]; ++x)
+		{
+			switch(bytes_per_voxel)
+			{
+				case 1:
+					data[position+x] = reinterpret_cast<const uint8_t*>(buffer.data())[x];
+					break;
+				case 2:
+					data[position+x] = reinterpret_cast<const uint16_t*>(buffer.data())[x];
+					break;
+				default:
+					data[position+x] = int(reinterpret_cast<const uint32_t*>(buffer.data())[x]);
+					break;
+			}
+		}
+	});
+}
+
+RawVolumeWriter::RawVolumeWriter(std::string file_name, const std::vector<int> &dimensions)
+: dimensions(dimensions)
+{
+	std::size_t length = 1;
+	for(int d : dimensions)
+	{
+		length *= d;
+	}
+	{
+		std::ofstream create(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+		if(!create || (length > 0 && !create.seekp(length-1).put(0)))
+		{
+			throw std::runtime_error("Could not create '" + file_name + "'!");
+		}
+	}
+	file.open(file_name, std::ios::in | std::ios::out | std::ios::binary);
+	if(!file)
+	{
+		throw std::runtime_error("Could not open '" + file_name + "'!");
+	}
+}
+
+void RawVolumeWriter::write(const std::vector<int> &offset, const std::vector<int> &size, const unsigned char *data)
+{
+	forEachRow(offset, size, [&](int y, int z, std::size_t position)
+	{
+		std::size_t voxel = (std::size_t(z)*dimensions[1] + y)*dimensions[0] + offset[0];
+		file.seekp(voxel);
+		if(!file.write(reinterpret_cast<const char*>(data+position), size[0]))
+		{
+			throw std::runtime_error("Writing raw volume failed.");
+		}
+	});
+	file.flush();
+}
+
+HDF5VolumeReader::HDF5VolumeReader(std::string file_name, std::string dataset_name)
+: file(file_name), dataset(file, dataset_name)
+{
+	H5S space(dataset);
+	int rank = space.getSimpleExtentNDims();
+	if(rank != 2 && rank != 3)
+	{
+		throw H5Exception("Dataset '" + dataset_name + "' has to be of rank 2 or 3!");
+	}
+	std::vector<hsize_t> h5_dimensions(rank);
+	space.getSimpleExtentDims(h5_dimensions.data());
+	dimensions.assign(h5_dimensions.rbegin(), h5_dimensions.rend());
+}
+
+void HDF5VolumeReader::read(const std::vector<int> &offset, const std::vector<int> &size, int *data)
+{
+	H5S file_space(dataset);
+	selectBox(file_space, offset, size);
+	std::vector<hsize_t> count = hdf5Dimensions(size);
+	H5S memory_space(int(count.size()), count.data());
+	if(H5Dread(dataset.getId(), H5T_NATIVE_INT, memory_space.getId(), file_space.getId(), H5P_DEFAULT, data) < 0)
+	{
+		throw H5Exception("Reading hyperslab failed");
+	}
+}
+
+HDF5VolumeWriter::HDF5VolumeWriter(std::string file_name, std::string dataset_name, const std::vector<int> &dimensions)
+: file(file_name, true), h5_dimensions(hdf5Dimensions(dimensions)), space(int(h5_dimensions.size()), h5_dimensions.data()),
+  dataset(file, dataset_name, H5T_STD_U8LE, space)
+{
+}
+
+void HDF5VolumeWriter::write(const std::vector<int> &offset, const std::vector<int> &size, const unsigned char *data)
+{
+	H5S file_space(dataset);
+	selectBox(file_space, offset, size);
+	std::vector<hsize_t> count = hdf5Dimensions(size);
+	H5S memory_space(int(count.size()), count.data());
+	if(H5Dwrite(dataset.getId(), H5T_NATIVE_UCHAR, memory_space.getId(), file_space.getId(), H5P_DEFAULT, data) < 0)
+	{
+		throw H5Exception("Writing hyperslab failed");
+	}
+}
+
+} /* end namespace elib */
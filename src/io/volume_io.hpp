@@ -0,0 +1,102 @@
+/*
+ * volume_io.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef VOLUME_IO_HPP_
+#define VOLUME_IO_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "hdf5_wrapper.hpp"
+
+namespace elib
+{
+
+/*
+ * Block-wise access to 2D/3D volumes which are too large to be held in memory. Dimensions are
+ * given as {width, height[, depth]} like for Image, boxes by their offset and size in the same
+ * order and the data of a box is stored with x running fastest.
+ */
+class VolumeReader
+{
+	public:
+		virtual ~VolumeReader() {}
+		const std::vector<int>& getDimensions() const
+		{
+			return dimensions;
+		}
+		virtual void read(const std::vector<int> &offset, const std::vector<int> &size, int *data) = 0;
+
+	protected:
+		std::vector<int> dimensions;
+};
+
+class VolumeWriter
+{
+	public:
+		virtual ~VolumeWriter() {}
+		virtual void write(const std::vector<int> &offset, const std::vector<int> &size, const unsigned char *data) = 0;
+};
+
+/* headerless file of unsigned 8, 16 or 32 bit voxels in native byte order */
+class RawVolumeReader : public VolumeReader
+{
+	public:
+		RawVolumeReader(std::string file_name, const std::vector<int> &dimensions, int bit_depth);
+
+		void read(const std::vector<int> &offset, const std::vector<int> &size, int *data);
+
+	private:
+		std::ifstream file;
+		int bytes_per_voxel;
+};
+
+/* headerless file of unsigned 8 bit voxels, the file is created with its full size */
+class RawVolumeWriter : public VolumeWriter
+{
+	public:
+		RawVolumeWriter(std::string file_name, const std::vector<int> &dimensions);
+
+		void write(const std::vector<int> &offset, const std::vector<int> &size, const unsigned char *data);
+
+	private:
+		std::fstream file;
+		std::vector<int> dimensions;
+};
+
+/* integer dataset of rank 2 or 3, read by hyperslabs */
+class HDF5VolumeReader : public VolumeReader
+{
+	public:
+		HDF5VolumeReader(std::string file_name, std::string dataset_name);
+
+		void read(const std::vector<int> &offset, const std::vector<int> &size, int *data);
+
+	private:
+		H5F file;
+		H5D dataset;
+};
+
+/* creates an unsigned 8 bit dataset in a new or existing file and writes it by hyperslabs */
+class HDF5VolumeWriter : public VolumeWriter
+{
+	public:
+		HDF5VolumeWriter(std::string file_name, std::string dataset_name, const std::vector<int> &dimensions);
+
+		void write(const std::vector<int> &offset, const std::vector<int> &size, const unsigned char *data);
+
+	private:
+		H5F file;
+		std::vector<hsize_t> h5_dimensions;
+		H5S space;
+		H5D dataset;
+};
+
+} /* end namespace elib */
+
+#endif /* VOLUME_IO_HPP_ */
@@ -8,21 +8,31 @@
 #include "library_link.hpp"
 
 #include <algorithm>
+#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "alg/alpha_shapes.hpp"
 #include "alg/bounding_volumes.hpp"
+#include "alg/components_features.hpp"
 #include "alg/delaunay_triangulation.hpp"
 #include "alg/density.hpp"
 #include "alg/graphcut.hpp"
+#include "alg/graphcut_session.hpp"
 #include "alg/multi_label_graphcut.hpp"
+#include "alg/projection_cache.hpp"
+#include "alg/tiled_graphcut.hpp"
 #include "io/hdf5_reader.hpp"
 #include "io/hdf5_wrapper.hpp"
+#include "io/volume_io.hpp"
 #include "library_link_utilities.hpp"
 #include "revision.hpp"
 #include "templates/image.hpp"
 #include "templates/tensor.hpp"
+#include "utilities/great_circle.hpp"
+#include "utilities/profile.hpp"
+#include "utilities/thread_pool.hpp"
 
 DLLEXPORT int llAlphaShape(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
@@ -84,6 +94,48 @@ DLLEXPORT int llBoundingVolumes(WolframLibraryData libData, mint nargs, MArgumen
 	return LIBRARY_NO_ERROR;
 }
 
+DLLEXPORT int llComponentsFeatures(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::ComponentsFeatures components_features;
+	MTensor features_tensor;
+	bool valid;
+
+//	int debug = 1;
+//	while(debug);
+
+	//get input, an empty intensity tensor skips the intensity features
+	elib::ImageView<int, mint> label_image = elib::LibraryLinkUtilities<int>::llGetIntegerImageView(libData,
+			MArgument_getMTensor(input[0]), 16, 1);
+	if(nargs > 2)
+	{
+		components_features.setNumberOfThreads(int(MArgument_getInteger(input[2]))); // threads
+	}
+	if(nargs > 1 && libData->MTensor_getFlattenedLength(MArgument_getMTensor(input[1])) > 0)
+	{
+		elib::ImageView<double, mreal> intensity_image = elib::LibraryLinkUtilities<double>::llGetRealImageView(libData,
+				MArgument_getMTensor(input[1]), 16, 1);
+		valid = components_features.measure(label_image, intensity_image);
+	}
+	else
+	{
+		valid = components_features.measure(label_image);
+	}
+	if(!valid)
+	{
+		sendMessage(libData, "llComponentsFeatures", "label and intensity image differ in size.");
+		return LIBRARY_DIMENSION_ERROR;
+	}
+
+	//one row per object
+	mint dims[2] = {components_features.getNumberOfObjects(), elib::ComponentsFeatures::NUMBER_OF_FEATURES};
+	libData->MTensor_new(MType_Real, 2, dims, &features_tensor);
+	std::copy(components_features.getFeatures()->begin(), components_features.getFeatures()->end(),
+			libData->MTensor_getRealData(features_tensor));
+	MArgument_setMTensor(output, features_tensor);
+
+	return LIBRARY_NO_ERROR;
+}
+
 DLLEXPORT int llDelaunay(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
 	using elib::Tensor;
@@ -111,8 +163,7 @@ DLLEXPORT int llDelaunay(WolframLibraryData libData, mint nargs, MArgument* inpu
 
 DLLEXPORT int llGraphCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
-	elib::Image<int> *input_image;
-	elib::Image<short> *binary_image;
+	elib::ScopedTimer timer("llGraphCut");
 	elib::Parameters params;
 	MTensor binary_tensor;
 
@@ -120,31 +171,81 @@ DLLEXPORT int llGraphCut(WolframLibraryData libData, mint nargs, MArgument* inpu
 //	while(debug);
 
 	//get input
-	input_image = elib::LibraryLinkUtilities<int>::llGetIntegerImage(libData, MArgument_getMTensor(input[0]),
-			MArgument_getInteger(input[1]), 1);
+	elib::ImageView<int, mint> input_image = elib::LibraryLinkUtilities<int>::llGetIntegerImageView(libData,
+			MArgument_getMTensor(input[0]), MArgument_getInteger(input[1]), 1);
 
 	params.addParameter("C0", MArgument_getReal(input[2])); // c0
 	params.addParameter("C1", MArgument_getReal(input[3])); // c1
 	params.addParameter("Lambda", MArgument_getReal(input[4])); // lambda
 	params.addParameter("Sigma", MArgument_getReal(input[5])); // sigma
+	if(nargs > 6)
+	{
+		params.addParameter("Solver", int(MArgument_getInteger(input[6]))); // solver
+	}
+	if(nargs > 7)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[7]))); // threads
+	}
 
-	//compute cut
-	binary_image = graphcut(*input_image, params);
-	if (binary_image == nullptr)
+	//compute cut directly into the output
+	elib::ImageView<short, mint> binary_image = elib::LibraryLinkUtilities<short>::llNewIntegerImageView(libData,
+			binary_tensor, *input_image.getDimensions(), input_image.getBitDepth());
+	if(!elib::graphcut(input_image, binary_image, params))
 	{
+		libData->MTensor_free(binary_tensor);
 		return LIBRARY_FUNCTION_ERROR;
 	}
-
-	//transform and write data to output
-	mint dimensions[input_image->getRank()];
-	std::reverse_copy(input_image->getDimensions()->begin(), input_image->getDimensions()->end(), dimensions);
-	libData->MTensor_new(MType_Integer, input_image->getRank(), dimensions, &binary_tensor);
-	std::copy(binary_image->getData(), binary_image->getData() + binary_image->getFlattenedLength(),
-			libData->MTensor_getIntegerData(binary_tensor));
 	MArgument_setMTensor(output, binary_tensor);
 
-	delete input_image;
-	delete binary_image;
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llGraphCutBatch(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Parameters params;
+	MTensor frames_tensor, binary_tensor;
+	int num_threads = 0;
+
+//	int debug = 1;
+//	while(debug);
+
+	//get input, frames are stacked along the first dimension
+	frames_tensor = MArgument_getMTensor(input[0]);
+	int bit_depth = MArgument_getInteger(input[1]),
+		rank = int(libData->MTensor_getRank(frames_tensor)) - 1;
+	if(rank != 2 && rank != 3)
+	{
+		sendMessage(libData, "llGraphCutBatch", "frames have to be of rank 2 or 3.");
+		return LIBRARY_RANK_ERROR;
+	}
+	const mint *tensor_dimensions = libData->MTensor_getDimensions(frames_tensor);
+	int num_frames = int(tensor_dimensions[0]);
+	std::vector<int> dimensions(rank);
+	std::reverse_copy(tensor_dimensions+1, tensor_dimensions+rank+1, dimensions.begin());
+
+	params.addParameter("C0", MArgument_getReal(input[2])); // c0
+	params.addParameter("C1", MArgument_getReal(input[3])); // c1
+	params.addParameter("Lambda", MArgument_getReal(input[4])); // lambda
+	params.addParameter("Sigma", MArgument_getReal(input[5])); // sigma
+	if(nargs > 6)
+	{
+		params.addParameter("Solver", int(MArgument_getInteger(input[6]))); // solver
+	}
+	if(nargs > 7)
+	{
+		num_threads = int(MArgument_getInteger(input[7])); // threads, frames are cut concurrently
+	}
+
+	//compute cuts on views of the frames, writing directly to the output; the workers only see plain pointers
+	libData->MTensor_new(MType_Integer, rank+1, tensor_dimensions, &binary_tensor);
+	const mint *frames_data = libData->MTensor_getIntegerData(frames_tensor);
+	mint *binary_data = libData->MTensor_getIntegerData(binary_tensor);
+	if(!elib::graphcutBatch(frames_data, binary_data, num_frames, dimensions, bit_depth, params, num_threads))
+	{
+		libData->MTensor_free(binary_tensor);
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	MArgument_setMTensor(output, binary_tensor);
 	return LIBRARY_NO_ERROR;
 }
 
@@ -154,8 +255,6 @@ DLLEXPORT int llGraphcutDistribution(WolframLibraryData libData, mint nargs, MAr
 	using elib::Tensor;
 	using elib::Parameters;
 
-	Image<int> *input_image;
-	std::unique_ptr<Image<short>> binary_image;
 	Parameters params;
 	MTensor binary_tensor;
 
@@ -163,8 +262,8 @@ DLLEXPORT int llGraphcutDistribution(WolframLibraryData libData, mint nargs, MAr
 //	while(debug);
 
 	//get input
-	input_image = elib::LibraryLinkUtilities<int>::llGetIntegerImage(libData, MArgument_getMTensor(input[0]),
-			MArgument_getInteger(input[1]), 1);
+	elib::ImageView<int, mint> input_image = elib::LibraryLinkUtilities<int>::llGetIntegerImageView(libData,
+			MArgument_getMTensor(input[0]), MArgument_getInteger(input[1]), 1);
 
 	std::shared_ptr<Tensor<float>> c0 = elib::LibraryLinkUtilities<float>::llGetRealTensor(libData,
 			MArgument_getMTensor(input[2]));
@@ -174,9 +273,68 @@ DLLEXPORT int llGraphcutDistribution(WolframLibraryData libData, mint nargs, MAr
 	params.addParameter("C1", *c1); // c1
 	params.addParameter("Lambda", MArgument_getReal(input[4])); // lambda
 	params.addParameter("Sigma", MArgument_getReal(input[4])); // sigma
+	if(nargs > 5)
+	{
+		params.addParameter("Solver", int(MArgument_getInteger(input[5]))); // solver
+	}
+	if(nargs > 6)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[6]))); // threads
+	}
+
+	//compute cut directly into the output
+	elib::ImageView<short, mint> binary_image = elib::LibraryLinkUtilities<short>::llNewIntegerImageView(libData,
+			binary_tensor, *input_image.getDimensions(), 8);
+	if(!elib::graphcutDistribution(input_image, binary_image, params))
+	{
+		libData->MTensor_free(binary_tensor);
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	MArgument_setMTensor(output, binary_tensor);
+
+	return LIBRARY_NO_ERROR;
+}
+
+namespace
+{
+	std::unordered_map<mint, std::unique_ptr<elib::GraphCutSession>> graphcut_sessions;
+	mint next_graphcut_session = 1;
+}
+
+DLLEXPORT int llGraphCutSessionCreate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Parameters params;
+
+	params.addParameter("C0", MArgument_getReal(input[0])); // c0
+	params.addParameter("C1", MArgument_getReal(input[1])); // c1
+	params.addParameter("Lambda", MArgument_getReal(input[2])); // lambda
+	params.addParameter("Sigma", MArgument_getReal(input[3])); // sigma
+	if(nargs > 4)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[4]))); // threads
+	}
+
+	mint handle = next_graphcut_session++;
+	graphcut_sessions[handle] = std::unique_ptr<elib::GraphCutSession>(new elib::GraphCutSession(params));
+	MArgument_setInteger(output, handle);
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llGraphCutSessionCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	MTensor binary_tensor;
+
+	auto session = graphcut_sessions.find(MArgument_getInteger(input[0]));
+	if(session == graphcut_sessions.end())
+	{
+		sendMessage(libData, "llGraphCutSessionCut", "unknown session.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	std::unique_ptr<elib::Image<int>> input_image(elib::LibraryLinkUtilities<int>::llGetIntegerImage(libData,
+			MArgument_getMTensor(input[1]), MArgument_getInteger(input[2]), 1));
 
 	//compute cut
-	graphcut(binary_image, *input_image, params);
+	std::unique_ptr<elib::Image<short>> binary_image(session->second->cut(*input_image));
 	if (binary_image == nullptr)
 	{
 		return LIBRARY_FUNCTION_ERROR;
@@ -189,13 +347,106 @@ DLLEXPORT int llGraphcutDistribution(WolframLibraryData libData, mint nargs, MAr
 	std::copy(binary_image->getData(), binary_image->getData() + binary_image->getFlattenedLength(),
 			libData->MTensor_getIntegerData(binary_tensor));
 	MArgument_setMTensor(output, binary_tensor);
+	return LIBRARY_NO_ERROR;
+}
 
-	delete input_image;
+DLLEXPORT int llGraphCutSessionRelease(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	if(graphcut_sessions.erase(MArgument_getInteger(input[0])) == 0)
+	{
+		sendMessage(libData, "llGraphCutSessionRelease", "unknown session.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	MArgument_setInteger(output, 0);
 	return LIBRARY_NO_ERROR;
 }
 
+DLLEXPORT int llTiledGraphCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	using elib::VolumeReader;
+	using elib::VolumeWriter;
+	std::unique_ptr<VolumeReader> reader;
+	std::unique_ptr<VolumeWriter> writer;
+	elib::Parameters params;
+	int tiles;
+
+//	int debug = 1;
+//	while(debug);
+
+	//get input, an empty dataset name selects a raw file
+	char *input_file = MArgument_getUTF8String(input[0]),
+		*input_dataset = MArgument_getUTF8String(input[1]),
+		*output_file = MArgument_getUTF8String(input[2]),
+		*output_dataset = MArgument_getUTF8String(input[3]);
+	std::shared_ptr<elib::Tensor<int>> raw_dimensions = elib::LibraryLinkUtilities<int>::llGetIntegerTensor(libData,
+			MArgument_getMTensor(input[4])); // {width, height[, depth]} of a raw input file
+	int bit_depth = MArgument_getInteger(input[5]);
+
+	params.addParameter("BitDepth", bit_depth); // bit depth
+	params.addParameter("C0", MArgument_getReal(input[6])); // c0
+	params.addParameter("C1", MArgument_getReal(input[7])); // c1
+	params.addParameter("Lambda", MArgument_getReal(input[8])); // lambda
+	params.addParameter("Sigma", MArgument_getReal(input[9])); // sigma
+	params.addParameter("Halo", int(MArgument_getInteger(input[10]))); // halo
+	params.addParameter("MemoryLimit", MArgument_getReal(input[11])); // memory limit in MB
+	if(nargs > 12)
+	{
+		params.addParameter("Solver", int(MArgument_getInteger(input[12]))); // solver
+	}
+	if(nargs > 13)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[13]))); // threads
+	}
+
+	//compute cut
+	try
+	{
+		if(std::string(input_dataset).empty())
+		{
+			std::vector<int> dimensions(raw_dimensions->getData(), raw_dimensions->getData() + raw_dimensions->getFlattenedLength());
+			reader = std::unique_ptr<VolumeReader>(new elib::RawVolumeReader(input_file, dimensions, bit_depth));
+		}
+		else
+		{
+			reader = std::unique_ptr<VolumeReader>(new elib::HDF5VolumeReader(input_file, input_dataset));
+		}
+		if(std::string(output_dataset).empty())
+		{
+			writer = std::unique_ptr<VolumeWriter>(new elib::RawVolumeWriter(output_file, reader->getDimensions()));
+		}
+		else
+		{
+			writer = std::unique_ptr<VolumeWriter>(new elib::HDF5VolumeWriter(output_file, output_dataset, reader->getDimensions()));
+		}
+		tiles = elib::tiledGraphcut(*reader, *writer, params);
+	}
+	catch (std::exception &e)
+	{
+		sendMessage(libData, "llTiledGraphCut", e.what());
+		tiles = -1;
+	}
+	libData->UTF8String_disown(input_file);
+	libData->UTF8String_disown(input_dataset);
+	libData->UTF8String_disown(output_file);
+	libData->UTF8String_disown(output_dataset);
+	if(tiles < 0)
+	{
+		return LIBRARY_FUNCTION_ERROR;
+	}
+
+	MArgument_setInteger(output, tiles);
+	return LIBRARY_NO_ERROR;
+}
+
+namespace
+{
+	/* of the last multi label graph cut */
+	std::vector<elib::MultiLabelGraphcut::TraceEntry> multilabel_graphcut_trace;
+}
+
 DLLEXPORT int llMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
+	elib::ScopedTimer timer("llMultiLabelGraphcut");
 	elib::Image<int> *input_image, *input_label_image;
 	std::shared_ptr<elib::Image<int>> label_image;
 	elib::Parameters params;
@@ -216,21 +467,56 @@ DLLEXPORT int llMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgu
 	params.addParameter("Lambda", MArgument_getReal(input[7])); // lambda
 	params.addParameter("Sigma", MArgument_getReal(input[8])); // sigma
 	params.addParameter("Mu", MArgument_getReal(input[9])); // mu
+	if(nargs > 10)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[10]))); // threads
+	}
+	if(nargs > 11)
+	{
+		params.addParameter("LabelRadius", int(MArgument_getInteger(input[11]))); // label radius
+	}
+	if(nargs > 12)
+	{
+		params.addParameter("Optimizer", int(MArgument_getInteger(input[12]))); // optimizer
+	}
+	if(nargs > 13)
+	{
+		params.addParameter("MaxCycles", int(MArgument_getInteger(input[13]))); // maximal number of cycles
+	}
+	if(nargs > 14)
+	{
+		params.addParameter("Epsilon", MArgument_getReal(input[14])); // minimal energy decrease per cycle
+	}
+	if(nargs > 15)
+	{
+		params.addParameter("TimeLimit", MArgument_getReal(input[15])); // time limit in milliseconds
+	}
+	if(nargs > 16)
+	{
+		params.addParameter("RandomLabelOrder", int(MArgument_getInteger(input[16]))); // random label order
+	}
+	if(nargs > 17)
+	{
+		params.addParameter("Neighborhood", int(MArgument_getInteger(input[17]))); // neighborhood of volumes
+	}
 
 	//compute cut
 	elib::MultiLabelGraphcut mlgc;
 	label_image = mlgc.multilabel_graphcut(*input_label_image, *input_image, params);
+	multilabel_graphcut_trace = mlgc.getTrace();
 	if (label_image == nullptr)
 	{
 		return LIBRARY_FUNCTION_ERROR;
 	}
 
 	//transform and write data to output
+	elib::ScopedTimer copy_timer("copy out");
 	mint dimensions[input_image->getRank()];
 	std::reverse_copy(input_image->getDimensions()->begin(), input_image->getDimensions()->end(), dimensions);
 	libData->MTensor_new(MType_Integer, input_image->getRank(), dimensions, &tensor);
 	std::copy(label_image->getData(), label_image->getData() + label_image->getFlattenedLength(),
 			libData->MTensor_getIntegerData(tensor));
+	elib::Profile::getInstance().addBytes("copy out", label_image->getFlattenedLength()*sizeof(mint));
 	MArgument_setMTensor(output, tensor);
 
 	delete input_image;
@@ -240,6 +526,7 @@ DLLEXPORT int llMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgu
 
 DLLEXPORT int llAdaptiveMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
+	elib::ScopedTimer timer("llAdaptiveMultiLabelGraphcut");
 	elib::Image<int> *input_image, *input_label_image;
 	std::shared_ptr<elib::Image<int>> label_image;
 	elib::Parameters params;
@@ -258,21 +545,60 @@ DLLEXPORT int llAdaptiveMultiLabelGraphcut(WolframLibraryData libData, mint narg
 	params.addParameter("Lambda", MArgument_getReal(input[5])); // lambda
 	params.addParameter("Sigma", MArgument_getReal(input[6])); // lambda1
 	params.addParameter("Mu", MArgument_getReal(input[7])); // mu
+	if(nargs > 8)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[8]))); // threads
+	}
+	if(nargs > 9)
+	{
+		params.addParameter("LabelRadius", int(MArgument_getInteger(input[9]))); // label radius
+	}
+	if(nargs > 10)
+	{
+		params.addParameter("Optimizer", int(MArgument_getInteger(input[10]))); // optimizer
+	}
+	if(nargs > 11)
+	{
+		params.addParameter("MaxCycles", int(MArgument_getInteger(input[11]))); // maximal number of cycles
+	}
+	if(nargs > 12)
+	{
+		params.addParameter("Epsilon", MArgument_getReal(input[12])); // minimal energy decrease per cycle
+	}
+	if(nargs > 13)
+	{
+		params.addParameter("TimeLimit", MArgument_getReal(input[13])); // time limit in milliseconds
+	}
+	if(nargs > 14)
+	{
+		params.addParameter("RandomLabelOrder", int(MArgument_getInteger(input[14]))); // random label order
+	}
+	if(nargs > 15)
+	{
+		params.addParameter("Neighborhood", int(MArgument_getInteger(input[15]))); // neighborhood of volumes
+	}
+	if(nargs > 16)
+	{
+		params.addParameter("HistogramSmoothing", MArgument_getReal(input[16])); // smoothing of the intensity histograms
+	}
 
 	//compute cut
 	elib::MultiLabelGraphcut mlgc;
 	label_image = mlgc.adaptive_multilabel_graphcut(*input_label_image, *input_image, params);
+	multilabel_graphcut_trace = mlgc.getTrace();
 	if (label_image == nullptr)
 	{
 		return LIBRARY_FUNCTION_ERROR;
 	}
 
 	//transform and write data to output
+	elib::ScopedTimer copy_timer("copy out");
 	mint dimensions[input_image->getRank()];
 	std::reverse_copy(input_image->getDimensions()->begin(), input_image->getDimensions()->end(), dimensions);
 	libData->MTensor_new(MType_Integer, input_image->getRank(), dimensions, &tensor);
 	std::copy(label_image->getData(), label_image->getData() + label_image->getFlattenedLength(),
 			libData->MTensor_getIntegerData(tensor));
+	elib::Profile::getInstance().addBytes("copy out", label_image->getFlattenedLength()*sizeof(mint));
 	MArgument_setMTensor(output, tensor);
 
 	delete input_image;
@@ -280,8 +606,27 @@ DLLEXPORT int llAdaptiveMultiLabelGraphcut(WolframLibraryData libData, mint narg
 	return LIBRARY_NO_ERROR;
 }
 
+DLLEXPORT int llMultiLabelGraphcutTrace(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	MTensor trace;
+
+	//cycle, energy and milliseconds per row
+	mint dims[2] = {mint(multilabel_graphcut_trace.size()), 3};
+	libData->MTensor_new(MType_Real, 2, dims, &trace);
+	double *trace_data = libData->MTensor_getRealData(trace);
+	for(std::size_t i=0; i<multilabel_graphcut_trace.size(); ++i)
+	{
+		trace_data[3*i] = multilabel_graphcut_trace[i].cycle;
+		trace_data[3*i+1] = multilabel_graphcut_trace[i].energy;
+		trace_data[3*i+2] = multilabel_graphcut_trace[i].milliseconds;
+	}
+	MArgument_setMTensor(output, trace);
+	return LIBRARY_NO_ERROR;
+}
+
 DLLEXPORT int llDensity(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
+	elib::ScopedTimer timer("llDensity");
 	elib::Parameters params;
 	std::shared_ptr<elib::Tensor<double>> points;
 	elib::Tensor<double> *result;
@@ -303,6 +648,14 @@ DLLEXPORT int llDensity(WolframLibraryData libData, mint nargs, MArgument* input
 	params.addParameter("Type", int(MArgument_getInteger(input[6])));
 	params.addParameter("CentralMeridian", MArgument_getReal(input[7]));
 	params.addParameter("StandardParallel", MArgument_getReal(input[8]));
+	if(nargs > 9)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[9]))); // threads
+	}
+	if(nargs > 10)
+	{
+		params.addParameter("Kernel", int(MArgument_getInteger(input[10]))); // Density::kernel_type, smooth kernels for CARTESIAN only
+	}
 
 	result = elib::Density::calculateDensity(*points, params);
 	if (result == nullptr)
@@ -310,11 +663,13 @@ DLLEXPORT int llDensity(WolframLibraryData libData, mint nargs, MArgument* input
 		return LIBRARY_FUNCTION_ERROR;
 	}
 
+	elib::ScopedTimer copy_timer("copy out");
 	mint dims[result->getRank()];
 	std::copy(result->getDimensions()->begin(), result->getDimensions()->end(), dims);
 	libData->MTensor_new(MType_Real, result->getRank(), dims, &density);
 	std::copy(result->getData(), result->getData() + result->getFlattenedLength(),
 			libData->MTensor_getRealData(density));
+	elib::Profile::getInstance().addBytes("copy out", result->getFlattenedLength()*sizeof(mreal));
 	MArgument_setMTensor(output, density);
 
 	delete result;
@@ -345,6 +700,10 @@ DLLEXPORT int llFeatureMap(WolframLibraryData libData, mint nargs, MArgument* in
 	params.addParameter("Type", int(MArgument_getInteger(input[7])));
 	params.addParameter("CentralMeridian", MArgument_getReal(input[8]));
 	params.addParameter("StandardParallel", MArgument_getReal(input[9]));
+	if(nargs > 10)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[10]))); // threads
+	}
 
 	result = elib::Density::calculateFeatureMap(*points, *features, params);
 	if (result == nullptr)
@@ -363,8 +722,221 @@ DLLEXPORT int llFeatureMap(WolframLibraryData libData, mint nargs, MArgument* in
 	return LIBRARY_NO_ERROR;
 }
 
+DLLEXPORT int llFeatureMaps(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Parameters params;
+	std::shared_ptr<elib::Tensor<double>> points, features, band_widths;
+	elib::Tensor<double> *result;
+	MTensor maps;
+	std::shared_ptr<elib::Tensor<int>> dimensions, original_dimensions;
+
+//	int debug = 1;
+//	while(debug);
+
+	points = elib::LibraryLinkUtilities<double>::llGetRealTensor(libData, MArgument_getMTensor(input[0]));
+	features = elib::LibraryLinkUtilities<double>::llGetRealTensor(libData, MArgument_getMTensor(input[1])); // points x features
+	band_widths = elib::LibraryLinkUtilities<double>::llGetRealTensor(libData, MArgument_getMTensor(input[2]));
+	dimensions = elib::LibraryLinkUtilities<int>::llGetIntegerTensor(libData, MArgument_getMTensor(input[3]));
+	params.addParameter("Dimensions", *dimensions);
+	original_dimensions = elib::LibraryLinkUtilities<int>::llGetIntegerTensor(libData, MArgument_getMTensor(input[4]));
+	params.addParameter("OriginalDimensions", *original_dimensions);
+	params.addParameter("Rank", 2);
+	params.addParameter("Radius", MArgument_getReal(input[5]));
+	params.addParameter("LateralProjectionRange", MArgument_getReal(input[6]));
+	params.addParameter("Type", int(MArgument_getInteger(input[7])));
+	params.addParameter("CentralMeridian", MArgument_getReal(input[8]));
+	params.addParameter("StandardParallel", MArgument_getReal(input[9]));
+	if(nargs > 10)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[10]))); // threads
+	}
+
+	result = elib::Density::calculateFeatureMaps(*points, *features, *band_widths, params);
+	if (result == nullptr)
+	{
+		sendMessage(libData, "llFeatureMaps", "features have to be a matrix with one row per point and at least one band width is needed.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+
+	//band widths x (features + count) x dimensions
+	mint dims[result->getRank()];
+	std::copy(result->getDimensions()->begin(), result->getDimensions()->end(), dims);
+	libData->MTensor_new(MType_Real, result->getRank(), dims, &maps);
+	std::copy(result->getData(), result->getData() + result->getFlattenedLength(),
+			libData->MTensor_getRealData(maps));
+	MArgument_setMTensor(output, maps);
+
+	delete result;
+	return LIBRARY_NO_ERROR;
+}
+
+namespace
+{
+	std::unordered_map<mint, std::unique_ptr<elib::DensityAccumulator>> density_accumulators;
+	mint next_density_accumulator = 1;
+}
+
+DLLEXPORT int llDensityAccumulatorCreate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Parameters params;
+	std::shared_ptr<elib::Tensor<int>> dimensions, original_dimensions;
+
+	dimensions = elib::LibraryLinkUtilities<int>::llGetIntegerTensor(libData, MArgument_getMTensor(input[0]));
+	params.addParameter("Dimensions", *dimensions);
+	original_dimensions = elib::LibraryLinkUtilities<int>::llGetIntegerTensor(libData, MArgument_getMTensor(input[1]));
+	params.addParameter("OriginalDimensions", *original_dimensions);
+	params.addParameter("Rank", 2);
+	params.addParameter("Radius", MArgument_getReal(input[2]));
+	params.addParameter("LateralProjectionRange", MArgument_getReal(input[3]));
+	params.addParameter("BandWidth", MArgument_getReal(input[4]));
+	params.addParameter("Type", int(MArgument_getInteger(input[5])));
+	params.addParameter("CentralMeridian", MArgument_getReal(input[6]));
+	params.addParameter("StandardParallel", MArgument_getReal(input[7]));
+	if(nargs > 8)
+	{
+		params.addParameter("Threads", int(MArgument_getInteger(input[8]))); // threads
+	}
+
+	std::unique_ptr<elib::DensityAccumulator> accumulator(new elib::DensityAccumulator(params));
+	if(!accumulator->isValid())
+	{
+		sendMessage(libData, "llDensityAccumulatorCreate", "invalid parameters, expected a BONNE, CARTESIAN or MERCATOR density type.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	mint handle = next_density_accumulator++;
+	density_accumulators[handle] = std::move(accumulator);
+	MArgument_setInteger(output, handle);
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llDensityAccumulatorUpdate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	auto accumulator = density_accumulators.find(MArgument_getInteger(input[0]));
+	if(accumulator == density_accumulators.end())
+	{
+		sendMessage(libData, "llDensityAccumulatorUpdate", "unknown accumulator.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	//rows {track, x, y}
+	std::shared_ptr<elib::Tensor<double>> tracks = elib::LibraryLinkUtilities<double>::llGetRealTensor(libData, MArgument_getMTensor(input[1]));
+	if(!accumulator->second->update(*tracks))
+	{
+		sendMessage(libData, "llDensityAccumulatorUpdate", "invalid parameters or tracks, expected rows {track, x, y} of distinct integral tracks.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	//number of tracks added, removed or moved
+	MArgument_setInteger(output, accumulator->second->getNumberOfChangedPoints());
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llDensityAccumulatorGet(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	MTensor density;
+
+	auto accumulator = density_accumulators.find(MArgument_getInteger(input[0]));
+	if(accumulator == density_accumulators.end())
+	{
+		sendMessage(libData, "llDensityAccumulatorGet", "unknown accumulator.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	std::unique_ptr<elib::Tensor<double>> result(accumulator->second->getDensity());
+	if(result == nullptr)
+	{
+		sendMessage(libData, "llDensityAccumulatorGet", "invalid parameters.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+
+	mint dims[result->getRank()];
+	std::copy(result->getDimensions()->begin(), result->getDimensions()->end(), dims);
+	libData->MTensor_new(MType_Real, result->getRank(), dims, &density);
+	std::copy(result->getData(), result->getData() + result->getFlattenedLength(),
+			libData->MTensor_getRealData(density));
+	MArgument_setMTensor(output, density);
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llDensityAccumulatorRelease(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	if(density_accumulators.erase(MArgument_getInteger(input[0])) == 0)
+	{
+		sendMessage(libData, "llDensityAccumulatorRelease", "unknown accumulator.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	MArgument_setInteger(output, 0);
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llProjectionCacheInfo(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	MTensor info;
+	elib::ProjectionCache &cache = elib::ProjectionCache::getInstance();
+
+	//hits, misses, grids, bytes, capacity in bytes
+	mint dims[1] = {5};
+	libData->MTensor_new(MType_Integer, 1, dims, &info);
+	mint *info_data = libData->MTensor_getIntegerData(info);
+	info_data[0] = cache.getHits();
+	info_data[1] = cache.getMisses();
+	info_data[2] = cache.getNumberOfGrids();
+	info_data[3] = cache.getSize();
+	info_data[4] = cache.getCapacity();
+	MArgument_setMTensor(output, info);
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llProjectionCacheClear(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::ProjectionCache::getInstance().clear();
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llProjectionCacheSetCapacity(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	mint capacity = MArgument_getInteger(input[0]); // bytes
+	if(capacity < 0)
+	{
+		sendMessage(libData, "llProjectionCacheSetCapacity", "the capacity has to be non-negative.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	elib::ProjectionCache::getInstance().setCapacity(std::size_t(capacity));
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llSetThreads(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	mint num_threads = MArgument_getInteger(input[0]); // 0 for the default
+	if(num_threads < 0)
+	{
+		sendMessage(libData, "llSetThreads", "the number of threads has to be non-negative.");
+		return LIBRARY_FUNCTION_ERROR;
+	}
+	elib::ThreadPool &pool = elib::ThreadPool::getInstance();
+	pool.setNumberOfThreads(int(num_threads));
+	MArgument_setInteger(output, pool.getNumberOfThreads());
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llThreadPoolInfo(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	MTensor info;
+	elib::ThreadPool &pool = elib::ThreadPool::getInstance();
+
+	//threads, tasks, busy and elapsed milliseconds of the workers, utilization
+	mint dims[1] = {5};
+	libData->MTensor_new(MType_Real, 1, dims, &info);
+	double *info_data = libData->MTensor_getRealData(info);
+	info_data[0] = pool.getNumberOfThreads();
+	info_data[1] = pool.getNumberOfTasks();
+	info_data[2] = pool.getBusyMilliseconds();
+	info_data[3] = pool.getElapsedMilliseconds();
+	info_data[4] = pool.getUtilization();
+	MArgument_setMTensor(output, info);
+	return LIBRARY_NO_ERROR;
+}
+
 DLLEXPORT int llHDF5Import(WolframLibraryData libData, MLINK mlp)
 {
+	elib::ScopedTimer timer("llHDF5Import");
 	const char *file_name;
 	const char *root;
 	std::vector<std::string> roots;
@@ -481,6 +1053,67 @@ DLLEXPORT int llHDF5Import(WolframLibraryData libData, MLINK mlp)
 	return LIBRARY_NO_ERROR;
 }
 
+DLLEXPORT int llGetProfile(WolframLibraryData libData, MLINK mlp)
+{
+	long length;
+	if(!MLCheckFunction(mlp, "List", &length) || length != 0)
+	{
+		sendMessage(libData, "llGetProfile", "function takes no parameters.");
+		MLPutSymbol(mlp, "$Failed");
+		return LIBRARY_NO_ERROR;
+	}
+
+	//<|"Phases" -> <|phase -> <|"Calls", "Milliseconds", "Bytes"|>, ...|>, "PeakBytes" -> ..., "Enabled" -> ...,
+	//"InstructionSet" -> instruction set of the density loops|>, phases are only recorded after llSetProfiling[True].
+	//"PeakBytes" is the peak of the working buffers the library registers (grid graphs, label regions, HDF5
+	//read buffers), not of the process heap.
+	elib::Profile &profile = elib::Profile::getInstance();
+	std::map<std::string, elib::Profile::Phase> phases = profile.getPhases();
+	MLPutFunction(mlp, "Association", 4);
+	MLPutFunction(mlp, "Rule", 2);
+	MLPutString(mlp, "Phases");
+	MLPutFunction(mlp, "Association", phases.size());
+	for(auto &phase : phases)
+	{
+		MLPutFunction(mlp, "Rule", 2);
+		MLPutString(mlp, phase.first.c_str());
+		MLPutFunction(mlp, "Association", 3);
+		MLPutFunction(mlp, "Rule", 2);
+		MLPutString(mlp, "Calls");
+		MLPutInteger64(mlp, phase.second.calls);
+		MLPutFunction(mlp, "Rule", 2);
+		MLPutString(mlp, "Milliseconds");
+		MLPutReal64(mlp, phase.second.milliseconds);
+		MLPutFunction(mlp, "Rule", 2);
+		MLPutString(mlp, "Bytes");
+		MLPutInteger64(mlp, phase.second.bytes);
+	}
+	MLPutFunction(mlp, "Rule", 2);
+	MLPutString(mlp, "PeakBytes");
+	MLPutInteger64(mlp, profile.getPeakBytes());
+	MLPutFunction(mlp, "Rule", 2);
+	MLPutString(mlp, "Enabled");
+	MLPutSymbol(mlp, profile.isEnabled() ? "True" : "False");
+	MLPutFunction(mlp, "Rule", 2);
+	MLPutString(mlp, "InstructionSet");
+	MLPutString(mlp, elib::greatCircleInstructionSet());
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llSetProfiling(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Profile &profile = elib::Profile::getInstance();
+	profile.setEnabled(MArgument_getBoolean(input[0])); // enable or disable the probes
+	MArgument_setBoolean(output, profile.isEnabled());
+	return LIBRARY_NO_ERROR;
+}
+
+DLLEXPORT int llResetProfile(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
+{
+	elib::Profile::getInstance().reset();
+	return LIBRARY_NO_ERROR;
+}
+
 DLLEXPORT int llVersion(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output)
 {
 	char *version = new char[1024];
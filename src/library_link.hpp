@@ -20,14 +20,34 @@ extern "C"
 
 DLLEXPORT int llAlphaShape(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llBoundingVolumes(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llComponentsFeatures(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llDelaunay(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llGraphCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llGraphCutBatch(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llGraphcutDistribution(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llGraphCutSessionCreate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llGraphCutSessionCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llGraphCutSessionRelease(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llTiledGraphCut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llAdaptiveMultiLabelGraphcut(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llMultiLabelGraphcutTrace(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llDensity(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llFeatureMap(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llFeatureMaps(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llDensityAccumulatorCreate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llDensityAccumulatorUpdate(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llDensityAccumulatorGet(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llDensityAccumulatorRelease(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llProjectionCacheInfo(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llProjectionCacheClear(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llProjectionCacheSetCapacity(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llSetThreads(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llThreadPoolInfo(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llHDF5Import(WolframLibraryData libData, MLINK mlp);
+DLLEXPORT int llGetProfile(WolframLibraryData libData, MLINK mlp);
+DLLEXPORT int llSetProfiling(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
+DLLEXPORT int llResetProfile(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 DLLEXPORT int llVersion(WolframLibraryData libData, mint nargs, MArgument* input, MArgument output);
 void sendMessage(WolframLibraryData libData, const char *function_name, const char *message);
 
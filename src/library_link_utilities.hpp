@@ -14,7 +14,9 @@
 #include "WolframLibrary.h"
 
 #include "templates/image.hpp"
+#include "templates/image_view.hpp"
 #include "templates/tensor.hpp"
+#include "utilities/profile.hpp"
 
 namespace elib
 {
@@ -25,26 +27,31 @@ class LibraryLinkUtilities
 	public:
 		static std::shared_ptr<Tensor<T>> llGetIntegerTensor(WolframLibraryData libData, MTensor& tensor)
 		{
+			ScopedTimer timer("copy in");
 			int rank = libData->MTensor_getRank(tensor);
 			std::vector<int> dimensions(rank);
 			std::copy(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank, dimensions.begin());
 			std::shared_ptr<Tensor<T>> new_tensor = std::shared_ptr<Tensor<T>>(new Tensor<T>(rank , dimensions));
 			std::copy(libData->MTensor_getIntegerData(tensor), libData->MTensor_getIntegerData(tensor)+libData->MTensor_getFlattenedLength(tensor), new_tensor->getData());
+			Profile::getInstance().addBytes("copy in", libData->MTensor_getFlattenedLength(tensor)*sizeof(mint));
 			return new_tensor;
 		}
 
 		static std::shared_ptr<Tensor<T>> llGetRealTensor(WolframLibraryData libData, MTensor& tensor)
 		{
+			ScopedTimer timer("copy in");
 			int rank = libData->MTensor_getRank(tensor);
 			std::vector<int> dimensions(rank);
 			std::copy(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank, dimensions.begin());
 			std::shared_ptr<Tensor<T>> new_tensor = std::shared_ptr<Tensor<T>>(new Tensor<T>(rank , dimensions));
 			std::copy(libData->MTensor_getRealData(tensor), libData->MTensor_getRealData(tensor)+libData->MTensor_getFlattenedLength(tensor), new_tensor->getData());
+			Profile::getInstance().addBytes("copy in", libData->MTensor_getFlattenedLength(tensor)*sizeof(mreal));
 			return new_tensor;
 		}
 
 		static Image<T>* llGetIntegerImage(WolframLibraryData libData, MTensor& tensor, mint bit_depth, mint channels)
 		{
+			ScopedTimer timer("copy in");
 			int rank;
 			if(channels > 1)
 			{
@@ -58,11 +65,13 @@ class LibraryLinkUtilities
 			std::reverse_copy(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank, dimensions.begin());
 			elib::Image<T> *image =  new Image<T>(rank, dimensions, int(bit_depth), int(channels));
 			std::copy(libData->MTensor_getIntegerData(tensor), libData->MTensor_getIntegerData(tensor)+libData->MTensor_getFlattenedLength(tensor), image->getData());
+			Profile::getInstance().addBytes("copy in", libData->MTensor_getFlattenedLength(tensor)*sizeof(mint));
 			return image;
 		}
 
 		static Image<T>* llGetRealImage(WolframLibraryData libData, MTensor& tensor, mint bit_depth, mint channels)
 		{
+			ScopedTimer timer("copy in");
 			int rank;
 			if(channels > 1)
 			{
@@ -76,8 +85,59 @@ class LibraryLinkUtilities
 			std::reverse_copy(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank, dimensions.begin());
 			elib::Image<T> *image = new Image<T>(rank, dimensions, int(bit_depth), int(channels));
 			std::copy(libData->MTensor_getRealData(tensor), libData->MTensor_getRealData(tensor)+libData->MTensor_getFlattenedLength(tensor), image->getData());
+			Profile::getInstance().addBytes("copy in", libData->MTensor_getFlattenedLength(tensor)*sizeof(mreal));
 			return image;
 		}
+
+		/*
+		 * Views on the data of an MTensor, nothing is copied. They are valid as long as the MTensor is.
+		 */
+		static TensorView<T, mint> llGetIntegerTensorView(WolframLibraryData libData, MTensor& tensor)
+		{
+			int rank = libData->MTensor_getRank(tensor);
+			std::vector<int> dimensions(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank);
+			return TensorView<T, mint>(libData->MTensor_getIntegerData(tensor), dimensions);
+		}
+
+		static TensorView<T, mreal> llGetRealTensorView(WolframLibraryData libData, MTensor& tensor)
+		{
+			int rank = libData->MTensor_getRank(tensor);
+			std::vector<int> dimensions(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank);
+			return TensorView<T, mreal>(libData->MTensor_getRealData(tensor), dimensions);
+		}
+
+		static ImageView<T, mint> llGetIntegerImageView(WolframLibraryData libData, MTensor& tensor, mint bit_depth, mint channels)
+		{
+			std::vector<int> dimensions = imageDimensions(libData, tensor, channels);
+			return ImageView<T, mint>(libData->MTensor_getIntegerData(tensor), dimensions, int(bit_depth), int(channels));
+		}
+
+		static ImageView<T, mreal> llGetRealImageView(WolframLibraryData libData, MTensor& tensor, mint bit_depth, mint channels)
+		{
+			std::vector<int> dimensions = imageDimensions(libData, tensor, channels);
+			return ImageView<T, mreal>(libData->MTensor_getRealData(tensor), dimensions, int(bit_depth), int(channels));
+		}
+
+		/* allocates an integer MTensor for a single channel image of the given dimensions and returns a view on it */
+		static ImageView<T, mint> llNewIntegerImageView(WolframLibraryData libData, MTensor& tensor, const std::vector<int> &dimensions, mint bit_depth)
+		{
+			std::vector<mint> tensor_dimensions(dimensions.rbegin(), dimensions.rend());
+			libData->MTensor_new(MType_Integer, tensor_dimensions.size(), tensor_dimensions.data(), &tensor);
+			return ImageView<T, mint>(libData->MTensor_getIntegerData(tensor), dimensions, int(bit_depth), 1);
+		}
+
+	private:
+		static std::vector<int> imageDimensions(WolframLibraryData libData, MTensor& tensor, mint channels)
+		{
+			int rank = int(libData->MTensor_getRank(tensor));
+			if(channels > 1)
+			{
+				rank -= 1;
+			}
+			std::vector<int> dimensions(rank);
+			std::reverse_copy(libData->MTensor_getDimensions(tensor),libData->MTensor_getDimensions(tensor)+rank, dimensions.begin());
+			return dimensions;
+		}
 };
 
 } /* namespace elib */
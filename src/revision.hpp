@@ -1,6 +1,6 @@
 #ifndef REVISION_HPP_
  #define REVISION_HPP_ 
 
- #define ELIB_REVISION "Unknown" 
+ #define ELIB_REVISION "0+34M" 
 
  #endif
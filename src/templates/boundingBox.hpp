@@ -64,6 +64,19 @@ class BoundingBox
 			}
 			return true;
 		}
+		bool overlap(BoundingBox<glm::ivec3> box)
+		{
+			glm::ivec3 	other_upper_left = box.getUpperLeft(),
+						other_bottom_right = box.getBottomRight();
+			if(upper_left.x > other_bottom_right.x || other_upper_left.x > bottom_right.x ||
+				upper_left.y > other_bottom_right.y || other_upper_left.y > bottom_right.y ||
+				upper_left.z > other_bottom_right.z || other_upper_left.z > bottom_right.z
+			)
+			{
+				return false;
+			}
+			return true;
+		}
 		Point getUpperLeft() const
 		{
 			return upper_left;
@@ -273,6 +273,14 @@ class Image
 		{
 			return data.get();
 		}
+		type get(std::size_t i) const
+		{
+			return data[i];
+		}
+		void set(std::size_t i, type value)
+		{
+			data[i] = value;
+		}
 		const std::vector<int>* getDimensions() const
 		{
 			return &dimensions;
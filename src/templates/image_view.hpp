@@ -0,0 +1,114 @@
+/*
+ * image_view.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef IMAGE_VIEW_HPP_
+#define IMAGE_VIEW_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace elib{
+
+/*
+ * Non-owning counterparts of Tensor and Image on memory owned by someone else, e.g. an MTensor.
+ * Elements are stored as S and accessed as T, conversions happen element-wise in get and set,
+ * so e.g. mint data is read as int without a converted copy of the whole array.
+ */
+template <typename T, typename S = T>
+class TensorView
+{
+	public:
+		TensorView(S *data, const std::vector<int> &dimensions)
+		: data(data), dimensions(dimensions), rank(dimensions.size())
+		{
+			flattened_length = 1;
+			for(int d : dimensions)
+			{
+				flattened_length *= d;
+			}
+		}
+
+		const std::vector<int>* getDimensions() const
+		{
+			return &dimensions;
+		}
+		std::size_t getFlattenedLength() const
+		{
+			return flattened_length;
+		}
+		int getRank() const
+		{
+			return rank;
+		}
+		S* getData() const
+		{
+			return data;
+		}
+		T get(std::size_t i) const
+		{
+			return T(data[i]);
+		}
+		void set(std::size_t i, T value)
+		{
+			data[i] = S(value);
+		}
+
+	private:
+		S *data;
+		std::vector<int> dimensions;
+		std::size_t flattened_length;
+		int rank;
+};
+
+template <typename T, typename S = T>
+class ImageView : public TensorView<T, S>
+{
+	public:
+		/* dimensions as for Image, {width, height[, depth]} */
+		ImageView(S *data, const std::vector<int> &dimensions, int bit_depth, int channels)
+		: TensorView<T, S>(data, dimensions), bit_depth(bit_depth), channels(channels)
+		{
+		}
+
+		int getBitDepth() const
+		{
+			return bit_depth;
+		}
+		int getChannels() const
+		{
+			return channels;
+		}
+		int getWidth() const
+		{
+			if(this->getRank()>0)
+				return (*this->getDimensions())[0];
+			else
+				return 0;
+		}
+		int getHeight() const
+		{
+			if(this->getRank()>1)
+				return (*this->getDimensions())[1];
+			else
+				return 0;
+		}
+		int getDepth() const
+		{
+			if(this->getRank()>2)
+				return (*this->getDimensions())[2];
+			else
+				return 1;
+		}
+
+	private:
+		int bit_depth,
+			channels;
+};
+
+} /* end namespace elib */
+
+#endif /* IMAGE_VIEW_HPP_ */
@@ -8,7 +8,6 @@
 #ifndef MASK_HPP_
 #define MASK_HPP_
 
-#include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -22,6 +21,7 @@
 #include "circular_linked_list.hpp"
 #include "glm/glm.hpp"
 #include "image.hpp"
+#include "run_length_mask.hpp"
 
 namespace elib{
 
@@ -36,11 +36,20 @@ class Mask
 		{
 			this->dimensions = std::vector<int>(dimensions.begin(), dimensions.end());
 		}
+		/* the pixels of runs in scan order */
+		explicit Mask(const RunLengthMask<Point> &runs) : rank(runs.getRank()), dimensions(*runs.getDimensions())
+		{
+			points.reserve(runs.getSize());
+			runs.forEachPoint([&](const Point &p)
+			{
+				points.push_back(p);
+			});
+		}
 		Mask(const Mask &other) : rank(other.rank), dimensions(other.dimensions), points(other.points)
 		{
-			if(other.mask != nullptr)
+			if(other.runs != nullptr)
 			{
-				mask = std::unique_ptr<boost::numeric::ublas::compressed_matrix<int>>(new boost::numeric::ublas::compressed_matrix<int>(*other.mask));
+				runs = std::unique_ptr<RunLengthMask<Point>>(new RunLengthMask<Point>(*other.runs));
 			}
 			if(other.bounding_box != nullptr)
 			{
@@ -48,7 +57,7 @@ class Mask
 			}
 		}
 		Mask(Mask&& other) : rank(other.rank), dimensions(std::move(other.dimensions)), points(std::move(other.points)),
-				mask(std::move(other.mask)), bounding_box(std::move(other.bounding_box))
+				runs(std::move(other.runs)), bounding_box(std::move(other.bounding_box))
 		{
 		}
 		virtual ~Mask()
@@ -59,9 +68,9 @@ class Mask
 			rank = other.rank;
 			dimensions = other.dimensions;
 			points = other.points;
-			if(other.mask != nullptr)
+			if(other.runs != nullptr)
 			{
-				mask = std::unique_ptr<boost::numeric::ublas::compressed_matrix<int>>(new boost::numeric::ublas::compressed_matrix<int>(*other.mask));
+				runs = std::unique_ptr<RunLengthMask<Point>>(new RunLengthMask<Point>(*other.runs));
 			}
 			if(other.bounding_box != nullptr)
 			{
@@ -74,14 +83,13 @@ class Mask
 			rank = other.rank;
 			dimensions = std::move(other.dimensions);
 			points = std::move(other.points);
-			mask = std::move(other.mask);
+			runs = std::move(other.runs);
 			bounding_box = std::move(other.bounding_box);
 			return *this;
 		}
+		/* run-length representations of both masks are built once and walked together, O(runs) */
 		bool overlap(Mask &other)
 		{
-			namespace ub = boost::numeric::ublas;
-
 			if(this->bounding_box == nullptr)
 			{
 				this->setBox(this->bounding_box);
@@ -92,46 +100,27 @@ class Mask
 			}
 			if(this->bounding_box->overlap(*other.bounding_box))
 			{
-				if(this->mask == nullptr)
+				if(this->runs == nullptr)
 				{
 					this->createSparseRepresentation();
 				}
-				if(other.mask == nullptr)
+				if(other.runs == nullptr)
 				{
 					other.createSparseRepresentation();
 				}
-				Mask mask(this->getRank(), *(this->getDimensions()));
-				boost::numeric::ublas::compressed_matrix<int> result;
-				try
-				{
-					result = boost::numeric::ublas::element_prod(*this->mask, *other.mask);
-				}
-				catch(const std::exception &e)
-				{
-					std::cout << "Can't get element product: " << e.what() << std::endl;
-					abort();
-				}
-				if(mask.getRank()==2)
-				{
-					for(auto i = result.begin1(); i!= result.end1(); ++i)
-					{
-						for(auto j= i.begin(); j != i.end(); ++j)
-							mask.addPoint(Point(j.index1(), j.index2()));
-					}
-				}
-				return bool(mask.getSize());
+				return this->runs->overlap(*other.runs);
 			}
 			return false;
 		}
 		void addPoint(Point p)
 		{
 			points.push_back(p);
-			mask.reset();
+			runs.reset();
 			bounding_box.reset();
 		}
 		void deleteSparseRepresentation()
 		{
-			mask.reset();
+			runs.reset();
 		}
 		const std::vector<Point>* getMask() const
 		{
@@ -242,27 +231,11 @@ class Mask
 			}
 		}
 
+		/* the pixels of the image not in mask, through the runs of the mask */
 		static Mask<glm::ivec3> negate(const Mask<glm::ivec3> &mask)
 		{
-			Mask<glm::ivec3> negated = Mask(mask.rank, mask.dimensions);
-			std::unordered_set<glm::ivec3, VectorHashFunctor> do_not_include;
-            do_not_include.insert(mask.getPoints()->begin(), mask.getPoints()->end());
-			glm::ivec3 p;
-			for(int k=0; k<mask.getDepth(); ++k)
-			{
-				for(int j=0; j<mask.getHeight(); ++j)
-				{
-					for(int i=0; i<mask.getWidth(); ++i)
-					{
-						p = glm::ivec3(i,j,k);
-						if(do_not_include.find(p) == do_not_include.end())
-						{
-							negated.addPoint(p);
-						}
-					}
-				}
-			}
-			return negated;
+			return Mask<glm::ivec3>(RunLengthMask<glm::ivec3>::negate(RunLengthMask<glm::ivec3>::fromPoints(mask.getRank(),
+					*mask.getDimensions(), *mask.getPoints())));
 		}
 
 	private:
@@ -270,7 +243,7 @@ class Mask
 		const static int bit_depth = 16;
 		std::vector<int> dimensions;
 		std::vector<Point> points;
-		std::unique_ptr<boost::numeric::ublas::compressed_matrix<int>> mask = nullptr;
+		std::unique_ptr<RunLengthMask<Point>> runs = nullptr;
 		std::unique_ptr<BoundingBox<Point>> bounding_box = nullptr;
 
 		inline int pixel(glm::ivec2 p)
@@ -283,17 +256,7 @@ class Mask
 		}
 		void createSparseRepresentation()
 		{
-			namespace ub = boost::numeric::ublas;
-			mask = std::unique_ptr<ub::compressed_matrix<int>>(new ub::compressed_matrix<int>(dimensions[0], dimensions[1], points.size()));
-			if(!mask)
-			{
-				std::cerr << "Creation of sparse representation failed!";
-				abort();
-			}
-			for(auto i=points.begin(); i!=points.end(); ++i)
-			{
-				mask->insert_element((*i).x, (*i).y, 1);
-			}
+			runs = std::unique_ptr<RunLengthMask<Point>>(new RunLengthMask<Point>(RunLengthMask<Point>::fromPoints(rank, dimensions, points)));
 		}
 		void setBox(std::unique_ptr<BoundingBox<glm::ivec2>> &box)
 		{
@@ -327,7 +290,7 @@ class Mask
 				maxY = std::max(maxY, it->y);
 				maxZ = std::max(maxZ, it->z);
 			}
-			std::unique_ptr<BoundingBox<glm::ivec3>>(new BoundingBox<glm::ivec3>(glm::ivec3(minX, minY, minZ), glm::ivec3(maxX+1, maxY+1, maxZ+1)));
+			box = std::unique_ptr<BoundingBox<glm::ivec3>>(new BoundingBox<glm::ivec3>(glm::ivec3(minX, minY, minZ), glm::ivec3(maxX, maxY, maxZ)));
 		}
 		std::string boxMask(const std::unique_ptr<BoundingBox<glm::ivec2>> &boundingBox)
 		{
@@ -0,0 +1,64 @@
+/*
+ * pairwise_weight_table.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef PAIRWISE_WEIGHT_TABLE_HPP_
+#define PAIRWISE_WEIGHT_TABLE_HPP_
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace elib{
+
+/*
+ * Pairwise weight of two intensities as function of their absolute difference, tabulated for all
+ * differences of an image with the given bit depth. Bit depths outside 0 to 16 are evaluated on the
+ * fly, as are differences exceeding the bit depth.
+ */
+template <typename T>
+class PairwiseWeightTable
+{
+	public:
+		const static int MAX_TABULATED_BIT_DEPTH = 16;
+
+		template <typename Function>
+		PairwiseWeightTable(int bit_depth, Function weight)
+		: weight(weight)
+		{
+			if(bit_depth >= 0 && bit_depth <= MAX_TABULATED_BIT_DEPTH)
+			{
+				table.resize(std::size_t(1) << bit_depth);
+				for(std::size_t d=0; d<table.size(); ++d)
+				{
+					table[d] = weight(int(d));
+				}
+			}
+		}
+
+		/* lambda*exp(-(d/max_intensity)^2/sigma), the contrast sensitive weight of graphcut */
+		static PairwiseWeightTable contrastSensitive(int bit_depth, T lambda, T sigma)
+		{
+			T max_intensity = std::pow(T(2), T(bit_depth))-1,
+				scale = 1/(sigma*max_intensity*max_intensity);
+			return PairwiseWeightTable(bit_depth, [=](int d) -> T { return lambda*std::exp(-T(d)*T(d)*scale); });
+		}
+
+		inline T operator()(int intensity1, int intensity2) const
+		{
+			unsigned int d = std::abs(intensity1 - intensity2);
+			return d < table.size() ? table[d] : weight(int(d));
+		}
+
+	private:
+		std::function<T(int)> weight;
+		std::vector<T> table;
+};
+
+} /* end namespace elib */
+
+#endif /* PAIRWISE_WEIGHT_TABLE_HPP_ */
@@ -0,0 +1,349 @@
+/*
+ * run_length_mask.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef RUN_LENGTH_MASK_HPP_
+#define RUN_LENGTH_MASK_HPP_
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "boundingBox.hpp"
+#include "glm/glm.hpp"
+#include "image.hpp"
+
+namespace elib{
+
+/*
+ * Mask stored as runs of consecutive pixels along x, sorted in scan order. Memory, size, bounding box
+ * and the set operations are linear in the number of runs, i.e. scale with the outline of an object
+ * instead of its area. Rows are numbered y + z*height. Mask keeps one as its representation for
+ * overlap tests and negation.
+ */
+template <class Point>
+class RunLengthMask
+{
+	public:
+		struct Run
+		{
+			int row;
+			int begin;	/* first x */
+			int end;	/* one past the last x */
+		};
+
+		RunLengthMask() noexcept
+		{
+		}
+		RunLengthMask(int rank, const std::vector<int> &dimensions) : rank(rank), dimensions(dimensions)
+		{
+		}
+		virtual ~RunLengthMask()
+		{
+		}
+
+		/* all pixels with the given label */
+		static RunLengthMask fromLabelImage(const Image<int> &label_image, int label)
+		{
+			RunLengthMask mask(label_image.getRank(), *label_image.getDimensions());
+			scan(label_image, [&](int row, int begin, int end, int value)
+			{
+				if(value == label)
+					mask.runs.push_back(Run{row, begin, end});
+			});
+			return mask;
+		}
+		/* one mask per positive label, built in a single scan */
+		static std::unordered_map<int, RunLengthMask> fromLabelImage(const Image<int> &label_image)
+		{
+			std::unordered_map<int, RunLengthMask> masks;
+			RunLengthMask empty(label_image.getRank(), *label_image.getDimensions());
+			scan(label_image, [&](int row, int begin, int end, int value)
+			{
+				if(value > 0)
+					masks.insert(std::make_pair(value, empty)).first->second.runs.push_back(Run{row, begin, end});
+			});
+			return masks;
+		}
+		/* the given pixels in any order, duplicates are fused */
+		static RunLengthMask fromPoints(int rank, const std::vector<int> &dimensions, std::vector<Point> points)
+		{
+			RunLengthMask mask(rank, dimensions);
+			std::sort(points.begin(), points.end(), [&](const Point &p1, const Point &p2)
+			{
+				return mask.row(p1) < mask.row(p2) || (mask.row(p1) == mask.row(p2) && p1.x < p2.x);
+			});
+			for(const Point &p : points)
+			{
+				mask.append(Run{mask.row(p), p.x, p.x+1});
+			}
+			return mask;
+		}
+		/* all pixels with a positive label */
+		static RunLengthMask foreground(const Image<int> &label_image)
+		{
+			RunLengthMask mask(label_image.getRank(), *label_image.getDimensions());
+			scan(label_image, [&](int row, int begin, int end, int value)
+			{
+				if(value > 0)
+					mask.append(Run{row, begin, end});
+			});
+			return mask;
+		}
+		static RunLengthMask negate(const RunLengthMask &mask)
+		{
+			RunLengthMask negated(mask.rank, mask.dimensions);
+			auto it = mask.runs.begin();
+			for(int row=0; row<mask.getHeight()*mask.getDepth(); ++row)
+			{
+				int x = 0;
+				for(; it!=mask.runs.end() && it->row == row; ++it)
+				{
+					if(it->begin > x)
+						negated.runs.push_back(Run{row, x, it->begin});
+					x = it->end;
+				}
+				if(x < mask.getWidth())
+					negated.runs.push_back(Run{row, x, mask.getWidth()});
+			}
+			return negated;
+		}
+
+		void addPoint(Point p)
+		{
+			addRun(row(p), p.x, p.x+1);
+		}
+		/* runs added in scan order are appended, others are merged in */
+		void addRun(int row, int begin, int end)
+		{
+			if(begin >= end)
+				return;
+			Run run{row, begin, end};
+			if(runs.empty() || runs.back().row < row || (runs.back().row == row && runs.back().begin <= begin))
+			{
+				append(run);
+			}
+			else
+			{
+				RunLengthMask single(rank, dimensions);
+				single.runs.push_back(run);
+				*this = unite(single);
+			}
+		}
+		bool overlap(const RunLengthMask &other) const
+		{
+			bool found = false;
+			intersect(other, [&](const Run&)
+			{
+				found = true;
+				return false;
+			});
+			return found;
+		}
+		RunLengthMask intersection(const RunLengthMask &other) const
+		{
+			RunLengthMask result(rank, dimensions);
+			intersect(other, [&](const Run &run)
+			{
+				result.runs.push_back(run);
+				return true;
+			});
+			return result;
+		}
+		RunLengthMask unite(const RunLengthMask &other) const
+		{
+			RunLengthMask result(rank, dimensions);
+			result.runs.reserve(runs.size() + other.runs.size());
+			auto a = runs.begin(),
+				b = other.runs.begin();
+			while(a != runs.end() || b != other.runs.end())
+			{
+				if(b == other.runs.end() || (a != runs.end() && before(*a, *b)))
+					result.append(*(a++));
+				else
+					result.append(*(b++));
+			}
+			return result;
+		}
+
+		/* number of pixels */
+		int getSize() const
+		{
+			int size = 0;
+			for(const Run &run : runs)
+			{
+				size += run.end - run.begin;
+			}
+			return size;
+		}
+		int getNumberOfRuns() const
+		{
+			return int(runs.size());
+		}
+		const std::vector<Run>* getRuns() const
+		{
+			return &runs;
+		}
+		/* inclusive corners as for Mask, an empty mask gives an inverted box */
+		BoundingBox<Point> getBoundingBox() const
+		{
+			int max = std::numeric_limits<int>::max(),
+				min = std::numeric_limits<int>::min();
+			glm::ivec3 lower(max, max, max),
+				upper(min, min, min);
+			for(const Run &run : runs)
+			{
+				int y = run.row % getHeight(),
+					z = run.row / getHeight();
+				lower = glm::ivec3(std::min(lower.x, run.begin), std::min(lower.y, y), std::min(lower.z, z));
+				upper = glm::ivec3(std::max(upper.x, run.end-1), std::max(upper.y, y), std::max(upper.z, z));
+			}
+			Point upper_left, bottom_right;
+			setPoint(upper_left, lower);
+			setPoint(bottom_right, upper);
+			return BoundingBox<Point>(upper_left, bottom_right);
+		}
+		/* calls function(p) for every pixel in scan order */
+		template <typename Function>
+		void forEachPoint(Function function) const
+		{
+			Point p;
+			for(const Run &run : runs)
+			{
+				for(int x=run.begin; x<run.end; ++x)
+				{
+					setPoint(p, glm::ivec3(x, run.row % getHeight(), run.row / getHeight()));
+					function(p);
+				}
+			}
+		}
+		Image<int> toImage() const
+		{
+			Image<int> image(rank, dimensions, bit_depth, 1);
+			int *image_data = image.getData();
+			for(const Run &run : runs)
+			{
+				std::fill(image_data + std::size_t(run.row)*getWidth() + run.begin, image_data + std::size_t(run.row)*getWidth() + run.end, 1);
+			}
+			return image;
+		}
+
+		const std::vector<int>* getDimensions() const
+		{
+			return &dimensions;
+		}
+		int getRank() const
+		{
+			return rank;
+		}
+		int getWidth() const
+		{
+			if(rank>0)
+				return dimensions[0];
+			else
+				return 0;
+		}
+		int getHeight() const
+		{
+			if(rank>1)
+				return dimensions[1];
+			else
+				return 0;
+		}
+		int getDepth() const
+		{
+			if(rank>2)
+				return dimensions[2];
+			else
+				return 1;
+		}
+
+	private:
+		int rank = 0;
+		const static int bit_depth = 16;
+		std::vector<int> dimensions;
+		std::vector<Run> runs;
+
+		/* calls function(row, begin, end, value) for every run of equal values of the image */
+		template <typename Function>
+		static void scan(const Image<int> &image, Function function)
+		{
+			const int *data = image.getData();
+			int width = image.getWidth(),
+				rows = image.getHeight()*image.getDepth();
+			for(int row=0; row<rows; ++row)
+			{
+				const int *line = data + std::size_t(row)*width;
+				int begin = 0;
+				for(int x=1; x<=width; ++x)
+				{
+					if(x == width || line[x] != line[begin])
+					{
+						function(row, begin, x, line[begin]);
+						begin = x;
+					}
+				}
+			}
+		}
+		/* calls function(run) for the overlapping parts of both masks in scan order until it returns false */
+		template <typename Function>
+		void intersect(const RunLengthMask &other, Function function) const
+		{
+			auto a = runs.begin(),
+				b = other.runs.begin();
+			while(a != runs.end() && b != other.runs.end())
+			{
+				if(a->row == b->row)
+				{
+					int begin = std::max(a->begin, b->begin),
+						end = std::min(a->end, b->end);
+					if(begin < end && !function(Run{a->row, begin, end}))
+						return;
+					if(a->end < b->end)
+						++a;
+					else
+						++b;
+				}
+				else if(a->row < b->row)
+					++a;
+				else
+					++b;
+			}
+		}
+		/* appends a run not preceding the last one, fusing touching runs */
+		void append(const Run &run)
+		{
+			if(!runs.empty() && runs.back().row == run.row && run.begin <= runs.back().end)
+				runs.back().end = std::max(runs.back().end, run.end);
+			else
+				runs.push_back(run);
+		}
+		static bool before(const Run &run1, const Run &run2)
+		{
+			return run1.row < run2.row || (run1.row == run2.row && run1.begin < run2.begin);
+		}
+		inline int row(glm::ivec2 p) const
+		{
+			return p.y;
+		}
+		inline int row(glm::ivec3 p) const
+		{
+			return p.z*getHeight() + p.y;
+		}
+		static void setPoint(glm::ivec2 &p, glm::ivec3 q)
+		{
+			p = glm::ivec2(q.x, q.y);
+		}
+		static void setPoint(glm::ivec3 &p, glm::ivec3 q)
+		{
+			p = q;
+		}
+};
+
+} /* end namespace elib */
+
+#endif /* RUN_LENGTH_MASK_HPP_ */
@@ -68,7 +68,7 @@ class Tensor
 		}
 		Tensor(int rank, const std::vector<int> &dimensions, const T *data) : Tensor(rank, dimensions)
 		{
-			std::copy(data, data + this->flattened_length, this->data);
+			std::copy(data, data + this->flattened_length, this->data.get());
 		}
 		virtual ~Tensor()
 		{
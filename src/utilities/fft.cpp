@@ -0,0 +1,104 @@
+/*
+ * fft.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace elib
+{
+
+namespace
+{
+
+/* exp(-+2 Pi i k/n) for k < n/2 */
+std::vector<std::complex<double>> twiddles(int n, bool inverse)
+{
+	std::vector<std::complex<double>> w(std::max(1, n/2));
+	for(int k=0; k<n/2; ++k)
+	{
+		w[k] = std::polar(1., (inverse ? 2 : -2)*M_PI*k/n);
+	}
+	return w;
+}
+
+void transform(std::complex<double> *data, int n, const std::vector<std::complex<double>> &w)
+{
+	// bit reversal permutation
+	for(int i=1, j=0; i<n; ++i)
+	{
+		int bit = n >> 1;
+		for(; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if(i < j)
+			std::swap(data[i], data[j]);
+	}
+	for(int length=2; length<=n; length<<=1)
+	{
+		int half = length/2,
+			stride = n/length;
+		for(int begin=0; begin<n; begin+=length)
+		{
+			for(int k=0; k<half; ++k)
+			{
+				std::complex<double> u = data[begin+k],
+					v = data[begin+k+half]*w[k*stride];
+				data[begin+k] = u+v;
+				data[begin+k+half] = u-v;
+			}
+		}
+	}
+}
+
+} /* end anonymous namespace */
+
+int nextPowerOfTwo(int n)
+{
+	// the largest power of 2 representable as int, doubling beyond it would overflow
+	const int MAX_POWER = 1 << 30;
+	if(n > MAX_POWER)
+		return -1;
+	int power = 1;
+	while(power < n)
+		power <<= 1;
+	return power;
+}
+
+void fft(std::complex<double> *data, int n, bool inverse)
+{
+	transform(data, n, twiddles(n, inverse));
+}
+
+void fft2D(std::complex<double> *data, int width, int height, bool inverse, int num_threads)
+{
+	std::vector<std::complex<double>> row_twiddles = twiddles(width, inverse),
+		column_twiddles = twiddles(height, inverse);
+	parallelFor(0, height, [&](int j)
+	{
+		transform(data + std::size_t(j)*width, width, row_twiddles);
+	}, num_threads);
+	parallelFor(0, width, [&](int i)
+	{
+		std::vector<std::complex<double>> column(height);
+		for(int j=0; j<height; ++j)
+		{
+			column[j] = data[i + std::size_t(j)*width];
+		}
+		transform(column.data(), height, column_twiddles);
+		for(int j=0; j<height; ++j)
+		{
+			data[i + std::size_t(j)*width] = column[j];
+		}
+	}, num_threads);
+}
+
+} /*end namespace elib*/
@@ -0,0 +1,28 @@
+/*
+ * fft.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef FFT_HPP_
+#define FFT_HPP_
+
+#include <complex>
+
+namespace elib
+{
+	/* smallest power of 2 not less than n, -1 if it exceeds the range of int */
+	int nextPowerOfTwo(int n);
+
+	/*
+	 * In-place iterative radix-2 FFT of n values, n has to be a power of 2. Neither direction is
+	 * normalized, so an inverse transform of a transform scales the input by n.
+	 */
+	void fft(std::complex<double> *data, int n, bool inverse = false);
+	/* 2D FFT of a row-major width x height array, rows and then columns are transformed concurrently */
+	void fft2D(std::complex<double> *data, int width, int height, bool inverse = false, int num_threads = 0);
+
+} /*end namespace elib*/
+
+#endif /* FFT_HPP_ */
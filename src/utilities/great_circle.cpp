@@ -0,0 +1,157 @@
+/*
+ * great_circle.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "great_circle.hpp"
+
+#include <cmath>
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GREAT_CIRCLE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace elib
+{
+
+namespace
+{
+
+typedef void (*AccumulateFunction)(const float*, const float*, const float*, const double*, int, int, const float*, const float*, int, int*, double*);
+
+inline void addWeights(const double *weights, int num_weights, double *weight_sums)
+{
+	for(int w=0; w<num_weights; ++w)
+	{
+		weight_sums[w] += weights[w];
+	}
+}
+
+void accumulateScalar(const float *x, const float *y, const float *z, const double *weights, int num_weights, int n,
+		const float q[3], const float *max_squared_chords, int num_thresholds, int *counts, double *weight_sums)
+{
+	for(int k=0; k<n; ++k)
+	{
+		float dx = x[k]-q[0],
+			dy = y[k]-q[1],
+			dz = z[k]-q[2],
+			d2 = dx*dx + dy*dy + dz*dz;
+		for(int t=0; t<num_thresholds; ++t)
+		{
+			if(d2 <= max_squared_chords[t])
+			{
+				++counts[t];
+				addWeights(weights + std::size_t(k)*num_weights, num_weights, weight_sums + t*num_weights);
+			}
+		}
+	}
+}
+
+#ifdef GREAT_CIRCLE_X86_DISPATCH
+/* squares are summed in the order of accumulateScalar and without fused multiply-add, so all paths agree */
+__attribute__((target("avx2")))
+void accumulateAVX2(const float *x, const float *y, const float *z, const double *weights, int num_weights, int n,
+		const float q[3], const float *max_squared_chords, int num_thresholds, int *counts, double *weight_sums)
+{
+	__m256 qx = _mm256_set1_ps(q[0]),
+		qy = _mm256_set1_ps(q[1]),
+		qz = _mm256_set1_ps(q[2]);
+	int k = 0;
+	for(; k+8<=n; k+=8)
+	{
+		__m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x+k), qx),
+			dy = _mm256_sub_ps(_mm256_loadu_ps(y+k), qy),
+			dz = _mm256_sub_ps(_mm256_loadu_ps(z+k), qz),
+			d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		for(int t=0; t<num_thresholds; ++t)
+		{
+			unsigned int mask = _mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_set1_ps(max_squared_chords[t]), _CMP_LE_OQ));
+			counts[t] += __builtin_popcount(mask);
+			for(; mask && num_weights; mask &= mask-1)
+				addWeights(weights + std::size_t(k + __builtin_ctz(mask))*num_weights, num_weights, weight_sums + t*num_weights);
+		}
+	}
+	accumulateScalar(x+k, y+k, z+k, weights + std::size_t(k)*num_weights, num_weights, n-k, q, max_squared_chords, num_thresholds, counts, weight_sums);
+}
+
+__attribute__((target("avx512f")))
+void accumulateAVX512(const float *x, const float *y, const float *z, const double *weights, int num_weights, int n,
+		const float q[3], const float *max_squared_chords, int num_thresholds, int *counts, double *weight_sums)
+{
+	__m512 qx = _mm512_set1_ps(q[0]),
+		qy = _mm512_set1_ps(q[1]),
+		qz = _mm512_set1_ps(q[2]);
+	int k = 0;
+	for(; k+16<=n; k+=16)
+	{
+		__m512 dx = _mm512_sub_ps(_mm512_loadu_ps(x+k), qx),
+			dy = _mm512_sub_ps(_mm512_loadu_ps(y+k), qy),
+			dz = _mm512_sub_ps(_mm512_loadu_ps(z+k), qz),
+			d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+		for(int t=0; t<num_thresholds; ++t)
+		{
+			unsigned int mask = _mm512_cmp_ps_mask(d2, _mm512_set1_ps(max_squared_chords[t]), _CMP_LE_OQ);
+			counts[t] += __builtin_popcount(mask);
+			for(; mask && num_weights; mask &= mask-1)
+				addWeights(weights + std::size_t(k + __builtin_ctz(mask))*num_weights, num_weights, weight_sums + t*num_weights);
+		}
+	}
+	accumulateScalar(x+k, y+k, z+k, weights + std::size_t(k)*num_weights, num_weights, n-k, q, max_squared_chords, num_thresholds, counts, weight_sums);
+}
+#endif
+
+AccumulateFunction selectAccumulateFunction(const char *&name)
+{
+#ifdef GREAT_CIRCLE_X86_DISPATCH
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f"))
+	{
+		name = "avx512";
+		return accumulateAVX512;
+	}
+	if(__builtin_cpu_supports("avx2"))
+	{
+		name = "avx2";
+		return accumulateAVX2;
+	}
+#endif
+	name = "scalar";
+	return accumulateScalar;
+}
+
+const char *instruction_set = nullptr;
+const AccumulateFunction accumulate_function = selectAccumulateFunction(instruction_set);
+
+} /* end anonymous namespace */
+
+void accumulateWithinChords(const float *x, const float *y, const float *z, const double *weights, int num_weights, int n,
+		const float q[3], const float *max_squared_chords, int num_thresholds, int *counts, double *weight_sums)
+{
+	// a batch has to be filled to make up for switching to the vector unit
+	if(n < 16)
+		accumulateScalar(x, y, z, weights, num_weights, n, q, max_squared_chords, num_thresholds, counts, weight_sums);
+	else
+		accumulate_function(x, y, z, weights, num_weights, n, q, max_squared_chords, num_thresholds, counts, weight_sums);
+}
+
+float squaredChord(double band_width, double radius)
+{
+	double angle = radius > 0 ? band_width/radius : M_PI;
+	if(angle < 0)
+		return -1;
+	if(angle >= M_PI)
+		return 5;
+	double chord = 2*sin(angle/2);
+	return float(chord*chord);
+}
+
+const char* greatCircleInstructionSet()
+{
+	return instruction_set;
+}
+
+} /*end namespace elib*/
@@ -0,0 +1,35 @@
+/*
+ * great_circle.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef GREAT_CIRCLE_HPP_
+#define GREAT_CIRCLE_HPP_
+
+namespace elib
+{
+	/*
+	 * Great circle neighbourhood test on unit vectors in structure-of-arrays layout. Two points are within
+	 * a central angle a iff their chord |p-q| is at most 2*sin(a/2), which avoids all trigonometry per pair
+	 * and stays accurate for small angles, unlike a threshold on the dot product in single precision.
+	 *
+	 * For several thresholds with the distances computed once: counts[t] is increased by the number of points
+	 * k in [0,n) with |(x[k],y[k],z[k]) - q|^2 <= max_squared_chords[t] and the num_weights weights of each of
+	 * these points, row k of the row-major matrix weights, are added to weight_sums[t*num_weights ...
+	 * (t+1)*num_weights-1]. Evaluates 16 (AVX-512) or 8 (AVX2) points at a time if the CPU supports it,
+	 * selected at runtime.
+	 */
+	void accumulateWithinChords(const float *x, const float *y, const float *z, const double *weights, int num_weights, int n,
+			const float q[3], const float *max_squared_chords, int num_thresholds, int *counts, double *weight_sums);
+
+	/* squared chord of the central angle band_width/radius, larger than 4 for the whole sphere and negative for none */
+	float squaredChord(double band_width, double radius);
+
+	/* instruction set used by accumulateWithinChords, "avx512", "avx2" or "scalar" */
+	const char* greatCircleInstructionSet();
+
+} /*end namespace elib*/
+
+#endif /* GREAT_CIRCLE_HPP_ */
@@ -0,0 +1,99 @@
+/*
+ * parallel.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "utilities/thread_pool.hpp"
+
+namespace elib
+{
+	/* number of threads used when none is requested, at least 1, see ThreadPool */
+	inline int defaultNumberOfThreads()
+	{
+		return ThreadPool::getInstance().getNumberOfThreads();
+	}
+
+	/*
+	 * Calls function(i) for every i in [begin, end) on the calling thread and up to num_threads-1 workers of
+	 * the ThreadPool (num_threads <= 0 selects defaultNumberOfThreads()). Indices are handed out one at a
+	 * time, so iterations of different cost are balanced. The first exception thrown by function is rethrown
+	 * in the caller. Can be nested, the calling thread works on its own loop until it is done.
+	 */
+	template <typename Function>
+	void parallelFor(int begin, int end, Function function, int num_threads = 0)
+	{
+		if(end <= begin)
+			return;
+		int available = defaultNumberOfThreads();
+		if(num_threads <= 0 || num_threads > available)
+			num_threads = available;
+		if(num_threads > end-begin)
+			num_threads = end-begin;
+		if(num_threads == 1)
+		{
+			for(int i=begin; i<end; ++i)
+				function(i);
+			return;
+		}
+
+		// helpers may start after the loop is done, they only find no index left then
+		struct State
+		{
+			std::atomic<int> next, active;
+			std::exception_ptr error;
+			std::mutex mutex;
+			std::condition_variable done;
+		};
+		std::shared_ptr<State> state = std::make_shared<State>();
+		state->next = begin;
+		state->active = 0;
+		Function *f = &function;
+		auto loop = [state, f, end]()
+		{
+			int i;
+			while((i = state->next++) < end)
+			{
+				try
+				{
+					(*f)(i);
+				}
+				catch(...)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if(!state->error)
+						state->error = std::current_exception();
+					state->next = end;
+				}
+			}
+		};
+		for(int t=1; t<num_threads; ++t)
+		{
+			ThreadPool::getInstance().post([state, loop]()
+			{
+				++state->active;
+				loop();
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if(--state->active == 0)
+					state->done.notify_all();
+			});
+		}
+		loop();
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->done.wait(lock, [&state](){ return state->active == 0; });
+		if(state->error)
+			std::rethrow_exception(state->error);
+	}
+} /* end namespace elib */
+
+#endif /* PARALLEL_HPP_ */
@@ -0,0 +1,77 @@
+/*
+ * profile.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "profile.hpp"
+
+namespace elib
+{
+
+Profile::Profile()
+: enabled(false), allocated(0), peak(0)
+{
+}
+
+Profile& Profile::getInstance()
+{
+	static Profile profile;
+	return profile;
+}
+
+void Profile::setEnabled(bool enabled)
+{
+	this->enabled = enabled;
+}
+
+void Profile::addCall(const char *phase, double milliseconds)
+{
+	if(!isEnabled())
+		return;
+	std::lock_guard<std::mutex> lock(mutex);
+	Phase &entry = phases[phase];
+	++entry.calls;
+	entry.milliseconds += milliseconds;
+}
+
+void Profile::addBytes(const char *phase, long long bytes)
+{
+	if(!isEnabled())
+		return;
+	std::lock_guard<std::mutex> lock(mutex);
+	phases[phase].bytes += bytes;
+}
+
+void Profile::allocate(long long bytes)
+{
+	long long current = allocated += bytes,
+		previous = peak;
+	while(current > previous && !peak.compare_exchange_weak(previous, current));
+}
+
+void Profile::release(long long bytes)
+{
+	allocated -= bytes;
+}
+
+std::map<std::string, Profile::Phase> Profile::getPhases() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return phases;
+}
+
+long long Profile::getPeakBytes() const
+{
+	return peak;
+}
+
+void Profile::reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	phases.clear();
+	peak = allocated.load();
+}
+
+} /* end namespace elib */
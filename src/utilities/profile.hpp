@@ -0,0 +1,124 @@
+/*
+ * profile.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef PROFILE_HPP_
+#define PROFILE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace elib
+{
+
+/*
+ * Process wide registry of the time spent in named phases of the library functions, their number of calls
+ * and the bytes they copied, together with the peak of the working buffers registered by ScopedAllocation.
+ * Phases are coarse (once per call or per pass over an image), so a mutex serializes the updates. The
+ * registry is disabled by default, then the probes only read one flag and never lock.
+ */
+class Profile
+{
+	public:
+		struct Phase
+		{
+			long long calls = 0;
+			double milliseconds = 0;
+			long long bytes = 0;
+		};
+
+		static Profile& getInstance();
+
+		bool isEnabled() const
+		{
+			return enabled.load(std::memory_order_relaxed);
+		}
+		/* disabled by default */
+		void setEnabled(bool enabled);
+
+		void addCall(const char *phase, double milliseconds);
+		/* bytes copied by phase */
+		void addBytes(const char *phase, long long bytes);
+		/* working buffers currently alive, tracked even while disabled so the balance stays correct */
+		void allocate(long long bytes);
+		void release(long long bytes);
+
+		std::map<std::string, Phase> getPhases() const;
+		/* peak of the buffers registered by ScopedAllocation only, not of the process heap */
+		long long getPeakBytes() const;
+		/* clears the phases, the peak starts again at the buffers currently alive */
+		void reset();
+
+	private:
+		Profile();
+		Profile(const Profile&) = delete;
+		Profile& operator=(const Profile&) = delete;
+
+		std::atomic<bool> enabled;
+		std::atomic<long long> allocated, peak;
+		std::map<std::string, Phase> phases;
+		mutable std::mutex mutex;
+};
+
+/* adds the lifetime of the object, or the time until stop, to phase */
+class ScopedTimer
+{
+	public:
+		explicit ScopedTimer(const char *phase)
+		: phase(phase), active(Profile::getInstance().isEnabled())
+		{
+			if(active)
+				start = std::chrono::steady_clock::now();
+		}
+		~ScopedTimer()
+		{
+			stop();
+		}
+		/* ends the phase before the end of the scope */
+		void stop()
+		{
+			if(active)
+				Profile::getInstance().addCall(phase, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count());
+			active = false;
+		}
+
+	private:
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		const char *phase;
+		bool active;
+		std::chrono::steady_clock::time_point start;
+};
+
+/* counts a working buffer of the given size towards the peak while the object lives */
+class ScopedAllocation
+{
+	public:
+		explicit ScopedAllocation(std::size_t bytes)
+		: bytes(bytes)
+		{
+			Profile::getInstance().allocate(bytes);
+		}
+		~ScopedAllocation()
+		{
+			Profile::getInstance().release(bytes);
+		}
+
+	private:
+		ScopedAllocation(const ScopedAllocation&) = delete;
+		ScopedAllocation& operator=(const ScopedAllocation&) = delete;
+
+		long long bytes;
+};
+
+} /* end namespace elib */
+
+#endif /* PROFILE_HPP_ */
@@ -0,0 +1,215 @@
+/*
+ * thread_pool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace elib
+{
+
+namespace
+{
+
+/* pool and queue of the worker running on this thread */
+thread_local ThreadPool *current_pool = nullptr;
+thread_local int current_index = -1;
+
+int defaultThreads()
+{
+	const char *value = std::getenv("ELIB_NUM_THREADS");
+	if(value != nullptr && std::atoi(value) > 0)
+		return std::atoi(value);
+	unsigned int n = std::thread::hardware_concurrency();
+	return n > 0 ? int(n) : 1;
+}
+
+} /* end anonymous namespace */
+
+ThreadPool::ThreadPool()
+: next_worker(0), pending(0), tasks_run(0), busy_nanoseconds(0), start_time(std::chrono::steady_clock::now())
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stop();
+}
+
+ThreadPool& ThreadPool::getInstance()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+int ThreadPool::getNumberOfThreads()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(num_threads == 0)
+		num_threads = defaultThreads();
+	return num_threads;
+}
+
+void ThreadPool::setNumberOfThreads(int num_threads)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	stop();
+	this->num_threads = num_threads > 0 ? num_threads : defaultThreads();
+	tasks_run = 0;
+	busy_nanoseconds = 0;
+	start_time = std::chrono::steady_clock::now();
+}
+
+void ThreadPool::post(std::function<void()> task)
+{
+	if(current_pool == this)
+	{
+		Worker &worker = *workers[current_index];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(std::move(task));
+		++pending;
+	}
+	else
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		start();
+		if(workers.empty())
+		{
+			lock.unlock();
+			task();
+			return;
+		}
+		Worker &worker = *workers[next_worker++ % workers.size()];
+		std::lock_guard<std::mutex> worker_lock(worker.mutex);
+		worker.tasks.push_back(std::move(task));
+		++pending;
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	wake_up.notify_one();
+}
+
+long long ThreadPool::getNumberOfTasks() const
+{
+	return tasks_run;
+}
+
+double ThreadPool::getBusyMilliseconds() const
+{
+	return busy_nanoseconds*1e-6;
+}
+
+double ThreadPool::getElapsedMilliseconds() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start_time).count();
+}
+
+double ThreadPool::getUtilization() const
+{
+	std::size_t num_workers;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		num_workers = workers.size();
+	}
+	double elapsed = getElapsedMilliseconds();
+	if(num_workers == 0 || elapsed <= 0)
+		return 0;
+	return std::min(1., getBusyMilliseconds()/(num_workers*elapsed));
+}
+
+/* with mutex locked */
+void ThreadPool::start()
+{
+	if(!workers.empty())
+		return;
+	if(num_threads == 0)
+		num_threads = defaultThreads();
+	if(num_threads < 2)
+		return;
+	// all queues exist before the first worker may steal
+	for(int i=0; i<num_threads-1; ++i)
+		workers.push_back(std::unique_ptr<Worker>(new Worker()));
+	for(int i=0; i<num_threads-1; ++i)
+		workers[i]->thread = std::thread(&ThreadPool::run, this, i);
+	tasks_run = 0;
+	busy_nanoseconds = 0;
+	start_time = std::chrono::steady_clock::now();
+}
+
+/* with mutex locked, the workers finish all queued tasks */
+void ThreadPool::stop()
+{
+	if(workers.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping = true;
+	}
+	wake_up.notify_all();
+	for(auto &worker : workers)
+		worker->thread.join();
+	workers.clear();
+	stopping = false;
+}
+
+void ThreadPool::run(int index)
+{
+	current_pool = this;
+	current_index = index;
+	std::function<void()> task;
+	while(true)
+	{
+		if(pop(index, task))
+		{
+			auto start = std::chrono::steady_clock::now();
+			task();
+			task = nullptr;
+			busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count();
+			++tasks_run;
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake_up.wait(lock, [this](){ return pending > 0 || stopping; });
+		if(stopping && pending == 0)
+			break;
+	}
+	current_pool = nullptr;
+	current_index = -1;
+}
+
+/* the newest task of the own queue, otherwise the oldest of another */
+bool ThreadPool::pop(int index, std::function<void()> &task)
+{
+	int num_workers = int(workers.size());
+	for(int k=0; k<num_workers; ++k)
+	{
+		Worker &worker = *workers[(index+k) % num_workers];
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if(!worker.tasks.empty())
+		{
+			if(k == 0)
+			{
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(worker.tasks.front());
+				worker.tasks.pop_front();
+			}
+			--pending;
+			return true;
+		}
+	}
+	return false;
+}
+
+} /* end namespace elib */
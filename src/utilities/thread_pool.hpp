@@ -0,0 +1,100 @@
+/*
+ * thread_pool.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: kthierbach
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace elib
+{
+
+/*
+ * Process wide pool of worker threads, started on first use. Every worker has its own queue, tasks posted
+ * by a worker go to its own queue, others are distributed round robin, and idle workers steal from the
+ * queues of the others. The number of threads includes the thread posting the work, which takes part in
+ * parallelFor, so the pool runs one worker less. It is taken from setNumberOfThreads, the environment
+ * variable ELIB_NUM_THREADS or the hardware, in this order.
+ */
+class ThreadPool
+{
+	public:
+		static ThreadPool& getInstance();
+
+		/* at least 1 */
+		int getNumberOfThreads();
+		/*
+		 * num_threads <= 0 selects the default. Waits for the queued tasks of the current workers, which are
+		 * restarted on next use, and resets the statistics. Must not be called from a task.
+		 */
+		void setNumberOfThreads(int num_threads);
+
+		/* runs task on a worker, or directly if the pool has no workers */
+		void post(std::function<void()> task);
+		/* same as post, with the result or exception of function */
+		template <typename Function>
+		std::future<typename std::result_of<Function()>::type> submit(Function function)
+		{
+			typedef typename std::result_of<Function()>::type Result;
+			auto task = std::make_shared<std::packaged_task<Result()>>(function);
+			std::future<Result> result = task->get_future();
+			post([task](){ (*task)(); });
+			return result;
+		}
+
+		/* since the workers were started */
+		long long getNumberOfTasks() const;
+		double getBusyMilliseconds() const;
+		double getElapsedMilliseconds() const;
+		/* fraction of the time the workers were running tasks, in [0,1] */
+		double getUtilization() const;
+
+		~ThreadPool();
+
+	private:
+		struct Worker
+		{
+			std::deque<std::function<void()>> tasks;
+			std::mutex mutex;
+			std::thread thread;
+		};
+
+		ThreadPool();
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void start();
+		void stop();
+		void run(int index);
+		bool pop(int index, std::function<void()> &task);
+
+		int num_threads = 0;	/* 0 until the default was determined */
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::atomic<unsigned int> next_worker;
+		std::atomic<int> pending;	/* queued tasks */
+		bool stopping = false;
+		mutable std::mutex mutex;	/* guards the workers and the start time */
+		std::mutex sleep_mutex;	/* guards waiting for tasks */
+		std::condition_variable wake_up;
+
+		std::atomic<long long> tasks_run, busy_nanoseconds;
+		std::chrono::steady_clock::time_point start_time;
+};
+
+} /* end namespace elib */
+
+#endif /* THREAD_POOL_HPP_ */